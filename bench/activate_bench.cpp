@@ -0,0 +1,195 @@
+//
+//  activate_bench.cpp
+//  CNT
+//
+//  Throughput of feed_forward_network::activate on the stored genomes, before and after
+//  the dense slot phenotype. The "before" network is the unordered_map implementation it
+//  replaced, kept here as reference.
+//  Usage: activate_bench <res directory> [passes]
+//
+
+// C / C++
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// External
+
+// Project
+#include "../src/cneat.h"
+#include "../src/cann.h"
+#include "../src/OHLCVManager.hpp"
+#include "./bench_common.hpp"
+
+
+/**************************************************************************************
+ * Reference
+ * ---------
+ * Values in an unordered_map keyed by node, neurons copied per activation.
+ **************************************************************************************/
+
+class map_network {
+private:
+    struct map_neuron {
+        int node;
+        unsigned int activation_function;
+        unsigned int aggregation_function;
+        double bias;
+        double response;
+        std::vector<std::pair<int, double>> inputs;
+    };
+
+    std::vector<int> input_keys;
+    std::vector<int> output_keys;
+    std::vector<map_neuron> node_evals;
+    std::unordered_map<int, double> values;
+
+    double aggregate(const map_neuron &s_Neuron) {
+        double ret = 0.0;
+        for (auto it_link : s_Neuron.inputs) {
+            if (s_Neuron.aggregation_function == 1) {
+                ret *= values[it_link.first] * it_link.second;
+            } else {
+                ret += values[it_link.first] * it_link.second;
+            }
+        }
+
+        return s_Neuron.aggregation_function == 2 ? ret / s_Neuron.inputs.size() : ret;
+    }
+
+public:
+    void from_genome(cneat::genome &g) {
+        cann::feed_forward_network s_Layers;
+
+        input_keys = g.input_pins;
+        output_keys = g.output_pins;
+
+        std::vector<cneat::connection_gene> connections;
+        for (auto &it_connection : g.connection_genes) {
+            if (it_connection.enabled) {
+                connections.push_back(it_connection);
+            }
+        }
+
+        for (auto &layer : s_Layers.feed_forward_layers(g.input_pins, g.output_pins, g.connection_genes)) {
+            for (int node : layer) {
+                auto it_node = s_Layers.find_node(g.node_genes, node);
+                if (it_node == g.node_genes.end()) {
+                    continue;
+                }
+
+                map_neuron new_neuron{static_cast<int>(it_node->key), it_node->activation_function,
+                                      it_node->aggregation_function, it_node->bias, it_node->response, {}};
+                for (auto &conn : connections) {
+                    if (static_cast<int>(conn.to_node) == node) {
+                        new_neuron.inputs.push_back(std::make_pair(conn.from_node, conn.weight));
+                    }
+                }
+                node_evals.push_back(new_neuron);
+            }
+        }
+
+        for (int input : input_keys) {
+            values[input] = 0.0;
+        }
+        for (int output : output_keys) {
+            values[output] = 0.0;
+        }
+    }
+
+    void activate(std::vector<double> &inputs, std::vector<double> &outputs) {
+        for (size_t i = 0; i < inputs.size(); i++) {
+            values.find(input_keys[i])->second = inputs[i];
+        }
+
+        for (auto it_neuron : node_evals) {
+            double s = aggregate(it_neuron) * it_neuron.response + it_neuron.bias;
+
+            switch (it_neuron.activation_function) {
+                case 1:
+                    values[it_neuron.node] = std::tanh(s);
+                    break;
+                case 2:
+                    values[it_neuron.node] = std::sin(s);
+                    break;
+                default:
+                    values[it_neuron.node] = 1 / (1 + std::exp(-1 * s));
+                    break;
+            }
+        }
+
+        for (size_t us_it = 0; us_it < outputs.size(); us_it++) {
+            outputs[us_it] = values[us_it];
+        }
+    }
+};
+
+/**************************************************************************************
+ * Benchmark
+ **************************************************************************************/
+
+template<class Network>
+static double run(std::vector<cneat::genome> &v_Genomes, std::vector<std::vector<double>> &v_Data, size_t us_Passes,
+                  std::vector<double> &v_Outputs) {
+    std::vector<double> v_Out(2);
+    v_Outputs.clear();
+
+    auto t_Start = std::chrono::steady_clock::now();
+    for (auto &it_Genome : v_Genomes) {
+        Network s_Network;
+        s_Network.from_genome(it_Genome);
+
+        for (size_t p = 0; p < us_Passes; p++) {
+            for (auto &it_Row : v_Data) {
+                s_Network.activate(it_Row, v_Out);
+                if (p == 0) {
+                    v_Outputs.insert(v_Outputs.end(), v_Out.begin(), v_Out.end());
+                }
+            }
+        }
+    }
+
+    double f64_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+    return static_cast<double>(v_Genomes.size() * v_Data.size() * us_Passes) / f64_Seconds;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <res directory> [passes]" << std::endl;
+        return 2;
+    }
+
+    std::string s_Res(argv[1]);
+    size_t us_Passes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 3;
+    std::vector<cneat::genome> v_Genomes;
+
+    bench::load_genomes(s_Res + "/Best Genomes server1/*.genome", v_Genomes);
+    std::vector<std::vector<double>> v_Data = OHLCVManager::getlocalOHLCV(bench::dataset_path(s_Res), 30);
+
+    if (v_Genomes.empty() || v_Data.empty()) {
+        std::cerr << "No genomes or data in " << s_Res << std::endl;
+        return 1;
+    }
+
+    std::vector<double> v_Before, v_After;
+    double f64_Before = run<map_network>(v_Genomes, v_Data, us_Passes, v_Before);
+    double f64_After = run<cann::feed_forward_network>(v_Genomes, v_Data, us_Passes, v_After);
+
+    double f64_MaxDiff = 0.0;
+    for (size_t i = 0; i < v_Before.size(); i++) {
+        f64_MaxDiff = std::max(f64_MaxDiff, std::fabs(v_Before[i] - v_After[i]));
+    }
+
+    std::printf("activate: %zu genomes x %zu rows x %zu passes (EURUSD15)\n", v_Genomes.size(), v_Data.size(), us_Passes);
+    std::printf("  unordered_map  %12.0f candle-evals/s\n", f64_Before);
+    std::printf("  dense slots    %12.0f candle-evals/s  x%.2f\n", f64_After, f64_After / f64_Before);
+    std::printf("  max |output difference| %g\n", f64_MaxDiff);
+
+    return 0;
+}
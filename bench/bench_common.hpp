@@ -0,0 +1,111 @@
+//
+//  bench_common.hpp
+//  CNT
+//
+//  Helpers shared by the benchmarks: the stored genomes, a scratch home directory for
+//  the pools and the EURUSD15 dataset.
+//
+
+#ifndef bench_common_hpp
+#define bench_common_hpp
+
+// C / C++
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <glob.h>
+#include <ftw.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// External
+
+// Project
+#include "../src/cneat.h"
+
+
+namespace bench {
+
+    /**
+     *  Append the genomes matching a glob pattern.
+     *
+     *  \param s_Pattern The pattern, e.g. "<res>/Best Genomes server1/<name>.genome", name a glob.
+     *  \param v_Genomes The genomes to append to.
+     */
+
+    inline void load_genomes(const std::string &s_Pattern, std::vector<cneat::genome> &v_Genomes) {
+        cneat::network_info_container s_Info{1, 2, false, "/tmp"};
+        cneat::mutation_rate_container s_Rates;
+        glob_t s_Glob;
+
+        if (glob(s_Pattern.c_str(), 0, NULL, &s_Glob) != 0) {
+            return;
+        }
+
+        for (size_t i = 0; i < s_Glob.gl_pathc; i++) {
+            cneat::genome s_Genome(s_Info, s_Rates, 0);
+            std::ifstream fs_Genome(s_Glob.gl_pathv[i], std::ios::binary);
+            cereal::BinaryInputArchive c_Archive(fs_Genome);
+            s_Genome.serialize(c_Archive);
+            v_Genomes.push_back(s_Genome);
+        }
+
+        globfree(&s_Glob);
+    }
+
+    /**
+     *  The EURUSD15 dataset the stored genomes were trained on.
+     *
+     *  \param s_Res The res directory.
+     *  \return The path of the csv file.
+     */
+
+    inline std::string dataset_path(const std::string &s_Res) {
+        return s_Res + "/dataset/ForexData/EURUSD/EURUSD15_MetaQuots.csv";
+    }
+
+    /**
+     *  Temporary home directory of a cneat::pool: config links to res/config, the session
+     *  directories go to save. Removed again by the destructor.
+     */
+
+    class scratch_home {
+    public:
+        scratch_home(const std::string &s_Res) {
+            char p_Path[] = "/tmp/cnt_bench_XXXXXX";
+
+            if (mkdtemp(p_Path) == NULL) {
+                throw std::runtime_error("Could not create a bench home directory");
+            }
+            s_Path = p_Path;
+
+            char *p_Config = realpath((s_Res + "/config").c_str(), NULL);
+            if (p_Config == NULL || symlink(p_Config, (s_Path + "/config").c_str()) != 0 ||
+                mkdir((s_Path + "/save").c_str(), ACCESSPERMS) != 0) {
+                free(p_Config);
+                throw std::runtime_error("Could not prepare " + s_Path);
+            }
+            free(p_Config);
+        }
+
+        ~scratch_home() {
+            // Depth first, links are removed and not followed
+            nftw(s_Path.c_str(), [](const char *p_File, const struct stat *, int, struct FTW *) -> int {
+                return remove(p_File);
+            }, 16, FTW_DEPTH | FTW_PHYS);
+        }
+
+        const std::string &path() const noexcept {
+            return s_Path;
+        }
+
+    private:
+        std::string s_Path;
+    };
+
+} // End of namespace bench
+
+#endif /* bench_common_hpp */
@@ -0,0 +1,179 @@
+//
+//  claim_bench.cpp
+//  CNT
+//
+//  Contention of TraderPool::GetNextRaceEntries against a claimer with one lock per
+//  claim, as before the atomic chunk cursor. Every claimed entry costs a short busy
+//  loop instead of an evaluation, so the claims themselves dominate.
+//  Usage: claim_bench <res directory> [threads ...]
+//
+
+// C / C++
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+
+// External
+
+// Project
+#include "../src/TraderPool.hpp"
+#include "../src/WorkerPool.hpp"
+#include "./bench_common.hpp"
+
+
+/**************************************************************************************
+ * Reference
+ * ---------
+ * The entries of a rung in claim order behind one mutex.
+ **************************************************************************************/
+
+class mutex_claimer {
+public:
+    void reset(const std::vector<RaceEntry *> &v_Order) {
+        v_Entries = v_Order;
+        us_Next = 0;
+    }
+
+    size_t claim(std::vector<RaceEntry *> &v_Claimed, size_t us_Count) {
+        std::unique_lock<std::mutex> s_Lock(s_Mutex, std::try_to_lock);
+        if (!s_Lock.owns_lock()) {
+            s_Lock.lock();
+            ++us_Contended;
+        }
+        ++us_Locks;
+
+        size_t us_Claimed = 0;
+        while (us_Claimed < us_Count && us_Next < v_Entries.size()) {
+            v_Claimed[us_Claimed++] = v_Entries[us_Next++];
+        }
+
+        return us_Claimed;
+    }
+
+    size_t us_Locks = 0;
+    size_t us_Contended = 0;
+
+private:
+    std::mutex s_Mutex;
+    std::vector<RaceEntry *> v_Entries;
+    size_t us_Next = 0;
+};
+
+/**************************************************************************************
+ * Benchmark
+ **************************************************************************************/
+
+static void work(double f64_Nanoseconds) {
+    auto t_Start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t_Start).count() <
+           f64_Nanoseconds) {
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <res directory> [threads ...]" << std::endl;
+        return 2;
+    }
+
+    std::string s_Res(argv[1]);
+    std::vector<unsigned int> v_Threads;
+    for (int i = 2; i < argc; i++) {
+        v_Threads.push_back(static_cast<unsigned int>(std::strtoul(argv[i], nullptr, 10)));
+    }
+    if (v_Threads.empty()) {
+        v_Threads = {64, 128};
+    }
+
+    const size_t us_Rungs = 100;
+    const size_t us_Lockstep = 1;
+    const double f64_Work = 2000.0;
+
+    bench::scratch_home s_Home(s_Res);
+    TraderPool s_Pool(s_Home.path(), 10, 2);
+
+    std::printf("claim: %u genomes, %zu rungs, %.0f ns per entry, lockstep %zu, %u hardware threads\n",
+                s_Pool.GetPopulationSize(), us_Rungs, f64_Work, us_Lockstep, std::thread::hardware_concurrency());
+
+    for (unsigned int ui_Threads : v_Threads) {
+        if (ui_Threads == 0) {
+            continue;
+        }
+
+        WorkerPool s_Workers(ui_Threads - 1);
+        s_Pool.SetClaiming(ui_Threads, us_Lockstep);
+
+        mutex_claimer s_Mutex;
+        std::atomic<size_t> us_Claimed(0);
+        ClaimReport s_Atomic = {0, 0, 0};
+        double f64_MutexTime = 0.0, f64_AtomicTime = 0.0;
+        size_t us_Entries = 0;
+
+        std::function<void()> f_Mutex = [&]() {
+            std::vector<RaceEntry *> v_Claim(us_Lockstep);
+            size_t us_Count;
+            while ((us_Count = s_Mutex.claim(v_Claim, us_Lockstep)) > 0) {
+                work(f64_Work * us_Count);
+                us_Claimed += us_Count;
+            }
+        };
+
+        std::function<void()> f_Atomic = [&]() {
+            std::vector<RaceEntry *> v_Claim(us_Lockstep);
+            RaceClaim s_Claim = {0, 0, 0, 0};
+            size_t us_Count;
+            while ((us_Count = s_Pool.GetNextRaceEntries(s_Claim, v_Claim, us_Lockstep)) > 0) {
+                work(f64_Work * us_Count);
+                us_Claimed += us_Count;
+            }
+            s_Pool.AddClaimReport(s_Claim);
+        };
+
+        for (size_t r = 0; r < us_Rungs; r++) {
+            // The claim order of the rung, taken by one thread for the reference
+            std::vector<RaceEntry *> v_Order, v_Claim(1);
+            RaceClaim s_Claim = {0, 0, 0, 0};
+            s_Pool.Reset();
+            while (s_Pool.GetNextRaceEntries(s_Claim, v_Claim, 1) > 0) {
+                v_Order.push_back(v_Claim[0]);
+            }
+            us_Entries += v_Order.size();
+
+            s_Mutex.reset(v_Order);
+            auto t_Start = std::chrono::steady_clock::now();
+            s_Workers.Run(f_Mutex);
+            f64_MutexTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+
+            s_Pool.Reset();
+            t_Start = std::chrono::steady_clock::now();
+            s_Workers.Run(f_Atomic);
+            f64_AtomicTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+
+            ClaimReport s_Report = s_Pool.GetClaimReport();
+            s_Atomic.us_Chunks += s_Report.us_Chunks;
+            s_Atomic.us_Groups += s_Report.us_Groups;
+            s_Atomic.us_Contended += s_Report.us_Contended;
+        }
+
+        if (us_Claimed != 2 * us_Entries) {
+            std::cerr << "Claimed " << us_Claimed << " of " << 2 * us_Entries << " entries" << std::endl;
+            return 1;
+        }
+
+        std::printf("  %3u threads, mutex   %8.1f us/rung, %6.3f locks/entry, %8zu contended (%.1f/rung)\n",
+                    ui_Threads, f64_MutexTime / us_Rungs * 1e6, static_cast<double>(s_Mutex.us_Locks) / us_Entries,
+                    s_Mutex.us_Contended, static_cast<double>(s_Mutex.us_Contended) / us_Rungs);
+        std::printf("  %3u threads, atomic  %8.1f us/rung, %6.3f chunks/entry, %8zu contended (%.1f/rung), %zu claims\n",
+                    ui_Threads, f64_AtomicTime / us_Rungs * 1e6, static_cast<double>(s_Atomic.us_Chunks) / us_Entries,
+                    s_Atomic.us_Contended, static_cast<double>(s_Atomic.us_Contended) / us_Rungs, s_Atomic.us_Groups);
+    }
+
+    return 0;
+}
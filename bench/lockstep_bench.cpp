@@ -0,0 +1,126 @@
+//
+//  lockstep_bench.cpp
+//  CNT
+//
+//  Throughput of ForexEval::evaluate with K genomes stepped through the rows together,
+//  K = 1, 4, 8 and 16. The population is filled with the stored genomes.
+//  Usage: lockstep_bench <res directory> [threads]
+//
+
+// C / C++
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <cstdio>
+#include <cstdlib>
+
+// External
+#include <../include/cereal/archives/json.hpp>
+
+// Project
+#include "../src/OHLCVManager.hpp"
+#include "../src/OHLCVDataset.hpp"
+#include "../src/WindowView.hpp"
+#include "../src/TraderPool.hpp"
+#include "../src/WorkerPool.hpp"
+#include "../src/EvalFunctions.h"
+#include "./bench_common.hpp"
+
+
+/**************************************************************************************
+ * Settings
+ * --------
+ * res/config/EvalSettings.json without the caches, they would skip the repeated genomes.
+ **************************************************************************************/
+
+static ForexEval make_eval(size_t us_Lockstep) {
+    std::stringstream ss_Json;
+    ss_Json << "{\"outputs\": 2, \"capital\": 1000.0, \"leverage\": 10, \"exposure\": 0.1, \"fee\": 0.00125,"
+            << " \"batch_size\": 1024, \"lockstep\": " << us_Lockstep << ", \"engine\": 0, \"precision\": 64,"
+            << " \"optimize\": 1, \"prune_weight\": 0.0, \"recurrent\": 0, \"phenotype_cache\": 0,"
+            << " \"race_segments\": 1, \"race_promotion\": 0.5, \"minibatch_windows\": 0, \"minibatch_rows\": 2048,"
+            << " \"minibatch_check\": 10, \"market\": 0, \"asset_fitness\": 0, \"validate\": 1,"
+            << " \"fitness_sharpe\": 0.0, \"fitness_drawdown\": 0.0, \"fitness_winrate\": 0.0,"
+            << " \"fitness_exposure\": 0.0, \"fitness_cache\": 0, \"schedule\": 1}";
+
+    ForexEval s_Eval;
+    cereal::JSONInputArchive c_Archive(ss_Json);
+    s_Eval.serialization(c_Archive);
+
+    return s_Eval;
+}
+
+/**************************************************************************************
+ * Benchmark
+ **************************************************************************************/
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <res directory> [threads]" << std::endl;
+        return 2;
+    }
+
+    std::string s_Res(argv[1]);
+    unsigned int ui_Threads = argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 1;
+    std::vector<cneat::genome> v_Genomes;
+
+    bench::load_genomes(s_Res + "/Best Genomes server1/*.genome", v_Genomes);
+
+    OHLCVDataset s_Dataset;
+    std::vector<double> v_Candles = OHLCVManager::getlocalCandles(bench::dataset_path(s_Res), s_Dataset);
+    std::vector<WindowView<double>> v_Data = {
+            WindowView<double>::Windows(v_Candles, s_Dataset.GetCandleSize(), 30, s_Dataset.GetClose<double>())};
+    size_t us_Rows = v_Data[0].GetRows();
+
+    if (v_Genomes.empty() || us_Rows == 0) {
+        std::cerr << "No genomes or data in " << s_Res << std::endl;
+        return 1;
+    }
+
+    bench::scratch_home s_Home(s_Res);
+    TraderPool s_Pool(s_Home.path(), static_cast<int>(v_Data[0].GetRowSize()), 2);
+    WorkerPool s_Workers(ui_Threads > 1 ? ui_Threads - 1 : 0);
+
+    // Every genome of the pool becomes one of the stored ones
+    size_t us_Population = 0;
+    for (size_t s = 0; s < s_Pool.GetSpeciesSize(); s++) {
+        cneat::genome *p_Genome;
+        for (size_t g = 0; (p_Genome = s_Pool.GetGenome(s, g)) != NULL; g++) {
+            *p_Genome = v_Genomes[us_Population++ % v_Genomes.size()];
+        }
+    }
+
+    std::printf("lockstep: %zu genomes x %zu rows, %u threads (EURUSD15)\n", us_Population, us_Rows, ui_Threads);
+
+    double f64_Single = 0.0;
+    for (size_t us_Lockstep : {1, 4, 8, 16}) {
+        ForexEval s_Eval = make_eval(us_Lockstep);
+        std::function<void()> f_Evaluate = [&]() {
+            ForexEval::evaluate(s_Eval, &s_Pool, v_Data);
+        };
+
+        s_Pool.SetClaiming(ui_Threads, us_Lockstep);
+        s_Pool.Reset();
+
+        auto t_Start = std::chrono::steady_clock::now();
+        do {
+            s_Workers.Run(f_Evaluate);
+        } while (s_Pool.NextRung(us_Rows));
+        double f64_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+
+        double f64_Fitness = 0.0;
+        for (double it_Fitness : s_Pool.GetFitness()) {
+            f64_Fitness += it_Fitness;
+        }
+
+        double f64_Throughput = static_cast<double>(us_Population * us_Rows) / f64_Seconds;
+        f64_Single = us_Lockstep == 1 ? f64_Throughput : f64_Single;
+        std::printf("  K = %2zu  %12.0f candle-evals/s  x%.2f  fitness sum %.10g\n", us_Lockstep, f64_Throughput,
+                    f64_Throughput / f64_Single, f64_Fitness);
+    }
+
+    return 0;
+}
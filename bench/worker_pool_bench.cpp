@@ -0,0 +1,86 @@
+//
+//  worker_pool_bench.cpp
+//  CNT
+//
+//  Wake-up latency of the WorkerPool threads and the CPU time the pool uses while idle.
+//  Every thread of a generation sleeps for a while instead of working, so the workers
+//  have to wake up even on a single core, and the CPU time of the generation is the cost
+//  of waking and waiting for them. The idle part parks the workers and measures the CPU
+//  time of the process meanwhile.
+//  Usage: worker_pool_bench [threads] [generations] [job us]
+//
+
+// C / C++
+#include <iostream>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/resource.h>
+
+// External
+
+// Project
+#include "../src/WorkerPool.hpp"
+
+
+/**************************************************************************************
+ * CPU time
+ **************************************************************************************/
+
+static double cpu_seconds() {
+    rusage s_Usage;
+    getrusage(RUSAGE_SELF, &s_Usage);
+
+    return static_cast<double>(s_Usage.ru_utime.tv_sec + s_Usage.ru_stime.tv_sec) +
+           static_cast<double>(s_Usage.ru_utime.tv_usec + s_Usage.ru_stime.tv_usec) * 1e-6;
+}
+
+/**************************************************************************************
+ * Benchmark
+ **************************************************************************************/
+
+int main(int argc, char *argv[]) {
+    unsigned int ui_Threads = argc > 1 ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 3;
+    size_t us_Generations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    size_t us_Job = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 200;
+
+    if (ui_Threads == 0 || us_Generations == 0) {
+        std::cerr << "Usage: " << argv[0] << " [threads > 0] [generations > 0] [job us]" << std::endl;
+        return 2;
+    }
+
+    WorkerPool s_Workers(ui_Threads);
+    std::function<void()> f_Job = [us_Job]() {
+        std::this_thread::sleep_for(std::chrono::microseconds(us_Job));
+    };
+
+    // Wake-up: one generation after the other
+    s_Workers.ResetWakeReport();
+    auto t_Start = std::chrono::steady_clock::now();
+    double f64_Cpu = cpu_seconds();
+    for (size_t g = 0; g < us_Generations; g++) {
+        s_Workers.Run(f_Job);
+    }
+    double f64_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+    f64_Cpu = cpu_seconds() - f64_Cpu;
+    WakeReport s_Wake = s_Workers.GetWakeReport();
+
+    // Idle: the workers are parked, the main thread sleeps
+    const double f64_Idle = 1.0;
+    double f64_IdleCpu = cpu_seconds();
+    std::this_thread::sleep_for(std::chrono::duration<double>(f64_Idle));
+    f64_IdleCpu = cpu_seconds() - f64_IdleCpu;
+
+    std::printf("worker pool: %u threads, %zu generations of %zu us, %u hardware threads\n", ui_Threads,
+                us_Generations, us_Job, std::thread::hardware_concurrency());
+    std::printf("  generation     %10.1f us, %.1f us CPU\n", f64_Seconds / us_Generations * 1e6,
+                f64_Cpu / us_Generations * 1e6);
+    std::printf("  wake-up        %10.1f us mean, %.1f us max (%zu wakes)\n", s_Wake.f64_Mean * 1e6,
+                s_Wake.f64_Max * 1e6, s_Wake.us_Wakes);
+    std::printf("  idle           %10.3f ms CPU in %.0f ms (%.2f%%)\n", f64_IdleCpu * 1e3, f64_Idle * 1e3,
+                100.0 * f64_IdleCpu / f64_Idle);
+
+    return 0;
+}
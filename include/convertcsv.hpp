@@ -42,7 +42,7 @@ namespace ConvertCSV {
      *  \return A vector containing a vector of doubles.
      */
 
-    std::vector<std::vector<double>> Convert(std::string s_FilePath, size_t us_Seperator) {
+    inline std::vector<std::vector<double>> Convert(std::string s_FilePath, size_t us_Seperator) {
         // Open the file
         std::ifstream f_File(s_FilePath);
 
@@ -98,6 +98,78 @@ namespace ConvertCSV {
         f_File.close();
         return v_Result;
     }
+
+    /**
+     *  Read a given CSV file record by record, as text.
+     *  Lines are split at ';' if they contain one, else at ','. Surrounding whitespace
+     *  and double quotes are removed from every field.
+     *
+     *  \param s_FilePath The full path to the file.
+     *  \param f_Record Called with the fields of every line which is not empty or commented out with #.
+     *                  Returning false stops reading.
+     */
+
+    template<class Function>
+    void ForEachRecord(const std::string &s_FilePath, Function f_Record) {
+        // Open the file
+        std::ifstream f_File(s_FilePath);
+
+        if (f_File.is_open() == false || f_File.bad() == true) {
+            throw std::runtime_error("File is not open!");
+        }
+
+        std::vector<std::string> v_Fields;
+        std::string s_Line;
+        size_t us_Current;
+        size_t us_Next;
+        size_t us_First;
+        size_t us_Last;
+        char c_Seperator;
+
+        // Loop file until EOF
+        while (std::getline(f_File, s_Line)) {
+            // Windows line endings
+            if (s_Line.size() > 0 && s_Line[s_Line.size() - 1] == '\r') {
+                s_Line.erase(s_Line.size() - 1);
+            }
+
+            // Skip lines which are either invalid or commented out with #
+            if (s_Line.size() == 0 || s_Line[0] == '#') {
+                continue;
+            }
+
+            c_Seperator = s_Line.find(';') != std::string::npos ? ';' : ',';
+            v_Fields.clear();
+            us_Current = 0;
+
+            // Read until all fields are found
+            do {
+                // Get position of the next seperator in line
+                if ((us_Next = s_Line.find(c_Seperator, us_Current)) == std::string::npos) {
+                    us_Next = s_Line.size();
+                }
+
+                // Trim whitespace and quotes
+                us_First = s_Line.find_first_not_of(" \t\"", us_Current);
+                us_Last = s_Line.find_last_not_of(" \t\"", us_Next - 1);
+                if (us_First == std::string::npos || us_First >= us_Next || us_Last < us_First || us_Next == 0) {
+                    v_Fields.push_back(std::string());
+                } else {
+                    v_Fields.push_back(s_Line.substr(us_First, us_Last - us_First + 1));
+                }
+
+                // +1 is used because us_Next defined the position of the seperator
+                us_Current = us_Next + 1;
+            } while (us_Next < s_Line.size()); // Exit once we readed the line end
+
+            if (!f_Record(v_Fields)) {
+                break;
+            }
+        }
+
+        // All done, clean up after ourselfs
+        f_File.close();
+    }
 }
 
 #endif /* CONVERTCSV_HPP */
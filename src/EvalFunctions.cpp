@@ -7,6 +7,8 @@
 //
 
 // C / C++
+#include <algorithm>
+#include <numeric>
 
 // External
 
@@ -20,445 +22,604 @@
  * Called on new and delete.
  **************************************************************************************/
 
-ForexEval::ForexEval() noexcept {
+template<class Market>
+BacktestEval<Market>::BacktestEval() noexcept {
     outputs = 2;
     capital = 1000;
     leverage = 10;
     exposure = 0.1; // 10% -> 0.1
     fee = 0.00125; // 0.125% -> 0.00125
+    batch_size = 1024;
+    lockstep = 8;
+    engine = 0;
+    precision = 64;
+    optimize = 1;
+    prune_weight = 0.0;
+    recurrent = 0;
+    phenotype_cache = 1024;
+    race_segments = 1;
+    race_promotion = 0.5;
+    minibatch_windows = 0;
+    minibatch_rows = 2048;
+    minibatch_check = 10;
+    market = 0;
+    asset_fitness = 0;
+    validate = 1;
+    fitness_sharpe = 0.0;
+    fitness_drawdown = 0.0;
+    fitness_winrate = 0.0;
+    fitness_exposure = 0.0;
+    fitness_cache = 65536;
+    schedule = 1;
 }
 
-ForexEval::~ForexEval() noexcept {}
+template<class Market>
+BacktestEval<Market>::~BacktestEval() noexcept {}
 
 /**************************************************************************************
- * Evaluate Forex
- * --------------
- * Evaluate pool genomes with Forex dataset.
+ * Evaluate
+ * --------
+ * Evaluate pool genomes on a dataset with the trading rules of Market.
  **************************************************************************************/
 
-void ForexEval::evaluate(ForexEval p_ForexEval, TraderPool *p_Pool, ThreadSync *p_ThreadSync,
-                         std::vector<std::vector<double>> &v_Data, bool b_MainThread) {
+template<class Market>
+template<typename T>
+void BacktestEval<Market>::evaluate(BacktestEval p_Eval, TraderPool *p_Pool, const std::vector<WindowView<T>> &v_Data) {
+    // Work on pool with the phenotype of the settings
+    if (p_Eval.recurrent) {
+        p_Eval.backtest<cann::basic_recurrent_network<T>>(p_Pool, v_Data);
+    } else {
+        p_Eval.backtest<cann::basic_feed_forward_network<T>>(p_Pool, v_Data);
+    }
+}
+
+template<class Market>
+template<class Network, typename T>
+void BacktestEval<Market>::backtest(TraderPool *p_Pool, const std::vector<WindowView<T>> &v_Data) {
     // Needed Variables
-    double starting_money = p_ForexEval.capital;
-    double current_money = starting_money;
-    double quantity = 0;
-    double open_price = 0.f;
-    int action;
-    int numact = 0;
-    double close;
-
-    size_t datasize = v_Data.size();
-    std::vector<double> out(p_Pool->GetOutputSize()); // Create out vector with size of the output nodes
-    cneat::genome *working_genome;
-    cann::feed_forward_network nn;
-
-    do {
-        if (!b_MainThread) {
-            // Wait for available data
-            p_ThreadSync->WaitForSignal();
-
-            // Thread kill
-            if (p_ThreadSync->GetKillThreads()) {
-                return;
+    size_t us_RowBegin;
+    size_t us_RowEnd;
+    size_t us_OutputSize = p_Pool->GetOutputSize();
+    size_t us_BlockSize = this->batch_size > 0 ? static_cast<size_t>(this->batch_size) : 1;
+    size_t us_Lockstep = this->lockstep > 1 ? static_cast<size_t>(this->lockstep) : 1;
+    size_t us_Genomes;
+    std::vector<T> out(us_BlockSize * us_OutputSize); // Outputs of one block of rows
+    std::vector<int> actions(us_Lockstep * us_BlockSize); // Actions of one block of rows, per genome
+    std::vector<RaceEntry *> working_entries(us_Lockstep);
+    RaceClaim s_Claim = {0, 0, 0, 0};
+    std::vector<Network> nn(us_Lockstep);
+
+    // Accounts of the genomes in lockstep
+    Market s_Market(this->leverage, this->exposure, this->fee);
+    std::vector<PositionSimulator<Market>> simulators(us_Lockstep, PositionSimulator<Market>(s_Market, this->capital));
+
+    // Mini-batch, summed fitness and actions over the windows
+    std::vector<std::pair<size_t, size_t>> v_Windows = p_Pool->GetWindows();
+    std::vector<double> score(us_Lockstep);
+    std::vector<double> profit(us_Lockstep);
+    std::vector<int> numact(us_Lockstep);
+
+    // Summed optimize() results, added to the pool once the pool is done
+    cann::optimization_report s_Report = cann::optimization_report();
+
+    // Built phenotypes of all threads, owned by the pool and sized at setup. Survivors and clones hit it.
+    // The settings from_genome() and optimize() depend on seed the key, runs with other settings never match.
+    // With phenotype_cache == 0 it is not touched.
+    cann::phenotype_cache<Network> &s_Cache = p_Pool->GetPhenotypeCache<Network>();
+    cann::cache_report s_CacheReport = {0, 0, 0};
+    uint64_t ui_Seed = cann::fnv1a(&this->engine, sizeof(this->engine));
+    ui_Seed = cann::fnv1a(&this->optimize, sizeof(this->optimize), ui_Seed);
+    ui_Seed = cann::fnv1a(&this->prune_weight, sizeof(this->prune_weight), ui_Seed);
+    uint64_t ui_Key;
+
+    // Claim up to us_Lockstep genomes of one asset and step them through the rows together
+    while ((us_Genomes = p_Pool->GetNextRaceEntries(s_Claim, working_entries, us_Lockstep)) > 0) {
+        const WindowView<T> &s_Data = v_Data[working_entries[0]->us_Asset];
+
+        // Rows of the current rung, all rows without racing
+        p_Pool->GetRaceSegment(s_Data.GetRows(), us_RowBegin, us_RowEnd);
+
+        for (size_t k = 0; k < us_Genomes; k++) {
+            cneat::genome *working_genome = working_entries[k]->p_Genome;
+
+            // Create ANN, or copy the phenotype of an unchanged genome
+            if (this->phenotype_cache > 0) {
+                ui_Key = cann::genome_hash(*working_genome, ui_Seed);
+                typename cann::phenotype_cache<Network>::pointer p_Cached = s_Cache.find(ui_Key);
+
+                if (p_Cached) {
+                    nn[k] = *p_Cached;
+                    ++s_CacheReport.hits;
+                } else {
+                    createNetwork(nn[k], *working_genome, s_Report);
+                    s_CacheReport.evictions += s_Cache.insert(ui_Key, std::make_shared<const Network>(nn[k]));
+                    ++s_CacheReport.misses;
+                }
+            } else {
+                createNetwork(nn[k], *working_genome, s_Report);
+            }
+
+            // Simulate Trading, from the start or where the last rung stopped
+            if (us_RowBegin == 0) {
+                simulators[k].Reset();
+            } else {
+                simulators[k].Resume(working_entries[k]->s_Position, working_entries[k]->s_Metrics,
+                                     working_entries[k]->b_Active);
             }
-        } else {
-            // Signal other threads
-            p_ThreadSync->NotifyWaiting();
         }
 
-        // Work on pool
-        while ((working_genome = p_Pool->GetNextGenome()) != NULL) {
-            // Create ANN
-            nn.from_genome(*working_genome);
+        /*****************************************
+         * Full dataset or rung of a race
+         *****************************************/
+
+        if (v_Windows.empty()) {
+            simulate(nn, simulators, us_Genomes, s_Data, us_RowBegin, us_RowEnd, us_OutputSize, out, actions);
+
+            // Write fitness, of the rows seen so far while racing
+            for (size_t k = 0; k < us_Genomes; k++) {
+                working_entries[k]->s_Position = simulators[k].GetPosition();
+                working_entries[k]->s_Metrics = simulators[k].GetMetrics();
+                working_entries[k]->b_Active = simulators[k].IsActive();
+                working_entries[k]->b_Acted = simulators[k].GetPosition().i_Actions > 0;
+                working_entries[k]->f64_Fitness = working_entries[k]->b_Acted ? getFitness(simulators[k]) : -300.0;
+                working_entries[k]->f64_Profit = simulators[k].GetProfit();
+            }
 
-            // Simulate Trading
-            starting_money = p_ForexEval.capital;
-            current_money = starting_money;
-            quantity = 0;
-            numact = 0;
+            continue;
+        }
 
-            // Backtesting
-            for (size_t it = 0; it < datasize; it++) {
-                /*****************************************
-                 * Get close price
-                 *****************************************/
+        /*****************************************
+         * Mini-batch
+         * Every window starts with the starting money and a fresh network state
+         *****************************************/
+
+        std::fill(score.begin(), score.end(), 0.0);
+        std::fill(profit.begin(), profit.end(), 0.0);
+        std::fill(numact.begin(), numact.end(), 0);
+        for (auto &it_Window : v_Windows) {
+            for (size_t k = 0; k < us_Genomes; k++) {
+                simulators[k].Reset();
+                resetNetwork(nn[k]);
+            }
 
-                close = v_Data[it][3];
+            simulate(nn, simulators, us_Genomes, s_Data, it_Window.first, it_Window.second, us_OutputSize, out,
+                     actions);
 
-                /*****************************************
-                 * Get Actions from ANN
-                 *****************************************/
+            for (size_t k = 0; k < us_Genomes; k++) {
+                score[k] += getFitness(simulators[k]);
+                profit[k] += simulators[k].GetProfit();
+                numact[k] += simulators[k].GetPosition().i_Actions;
+            }
+        }
 
-                action = p_ForexEval.getAction(nn, v_Data[it], out);
+        // Write fitness, the mean of the windows, -300 without any action like a full backtest
+        for (size_t k = 0; k < us_Genomes; k++) {
+            working_entries[k]->b_Acted = numact[k] > 0;
+            working_entries[k]->f64_Fitness = working_entries[k]->b_Acted ? score[k] / v_Windows.size() : -300.0;
+            working_entries[k]->f64_Profit = profit[k] / v_Windows.size();
+        }
+    }
 
-                /*****************************************
-                 * Money Check
-                 *****************************************/
+    p_Pool->AddOptimizationReport(s_Report);
+    p_Pool->AddCacheReport(s_CacheReport);
+    p_Pool->AddClaimReport(s_Claim);
+}
 
-                // Check if money is available
-                if (current_money <= 0) {
-                    current_money = 0;
-                    break;
-                }
+template<class Market>
+template<class Network, class Simulator, typename T>
+void BacktestEval<Market>::simulate(std::vector<Network> &nn, std::vector<Simulator> &simulators,
+                                    size_t us_Genomes, const WindowView<T> &s_Data, size_t us_RowBegin, size_t us_RowEnd,
+                                    size_t us_OutputSize, std::vector<T> &out, std::vector<int> &actions) {
+    const T *p_Close = s_Data.GetClose();
+    size_t us_BlockSize = out.size() / us_OutputSize;
+    size_t us_BlockEnd;
+    size_t us_Active = 0;
+
+    for (size_t k = 0; k < us_Genomes; k++) {
+        us_Active += simulators[k].IsActive() ? 1 : 0;
+    }
 
-                /*****************************************
-                 * Liquidation check
-                 *****************************************/
-
-                p_ForexEval.checkLiquidation(current_money, quantity, open_price, close);
-
-                /*****************************************
-                 * LONG POSITION
-                 *
-                 * Either close an open short position
-                 * or
-                 * Open a new Long position
-                 *
-                 *****************************************/
-
-                if (action == 1) {
-                    numact += 1;
-
-                    // Open new Long Position
-                    if (quantity == 0) {
-                        p_ForexEval.buyLong(current_money, quantity, open_price, close);
-                    }
-
-                        // Close current short position
-                    else if (quantity < 0) {
-                        p_ForexEval.sellShort(current_money, quantity, open_price, close);
-                    }
-                }
+    // Backtesting
+    for (size_t us_BlockStart = us_RowBegin; us_BlockStart < us_RowEnd && us_Active > 0; us_BlockStart = us_BlockEnd) {
+        us_BlockEnd = std::min(us_BlockStart + us_BlockSize, us_RowEnd);
 
-                    /*****************************************
-                     * SHORT POSITION
-                     *
-                     * Either close an open long position
-                     * or
-                     * open a ne short position
-                     *
-                     *****************************************/
-
-                else if (action == -1) {
-                    numact += 1;
-
-                    // Open new short position
-                    if (quantity == 0) {
-                        p_ForexEval.buyShort(current_money, quantity, open_price, close);
-                    }
-
-                        // Close existing Long position
-                    else if (quantity > 0) {
-                        p_ForexEval.sellLong(current_money, quantity, open_price, close);
-                    }
-                }
+        /*****************************************
+         * Get Actions from ANN
+         * The block is read by all genomes while it is hot in the cache
+         *****************************************/
+
+        for (size_t k = 0; k < us_Genomes; k++) {
+            if (simulators[k].IsActive()) {
+                getActions(nn[k], s_Data.GetRow(us_BlockStart), us_BlockEnd - us_BlockStart,
+                           s_Data.GetStride(), us_OutputSize, out.data(), &actions[k * us_BlockSize]);
             }
+        }
+
+        /*****************************************
+         * Simulate Trading
+         * Each genome runs its actions over the close prices of the block
+         *****************************************/
 
-            // Write fitness
-            working_genome->fitness = p_ForexEval.getFitness(current_money, starting_money, numact);
+        for (size_t k = 0; k < us_Genomes; k++) {
+            if (simulators[k].IsActive() &&
+                !simulators[k].Run(&actions[k * us_BlockSize], p_Close + us_BlockStart, us_BlockEnd - us_BlockStart)) {
+                --us_Active;
+            }
         }
-    } while (!b_MainThread);
+    }
 }
 
 /**************************************************************************************
- * Contract Buy / Sell contract
- * ----------------------------
- * Handle buying and selling.
+ * Score
+ * -----
+ * Backtest a single genome on all rows.
  **************************************************************************************/
 
-void ForexEval::buyLong(double &current_money, double &quantity, double &open_price, double &close) {
-    // Calculate quantity
-    quantity = ((current_money * this->exposure) * this->leverage) / 100000;
-    open_price = close;
+template<class Market>
+template<typename T>
+double BacktestEval<Market>::score(BacktestEval p_Eval, cneat::genome &s_Genome, const WindowView<T> &s_Data,
+                                   size_t us_OutputSize) {
+    if (p_Eval.recurrent) {
+        return p_Eval.scoreGenome<cann::basic_recurrent_network<T>>(s_Genome, s_Data, us_OutputSize);
+    }
+
+    return p_Eval.scoreGenome<cann::basic_feed_forward_network<T>>(s_Genome, s_Data, us_OutputSize);
 }
 
-void ForexEval::sellLong(double &current_money, double &quantity, double &open_price, double &close) {
-    // get how much we won or lost
-    current_money += ((close - open_price) * (100000.f * quantity));
+template<class Market>
+template<class Network, typename T>
+double BacktestEval<Market>::scoreGenome(cneat::genome &s_Genome, const WindowView<T> &s_Data, size_t us_OutputSize) {
+    size_t us_BlockSize = this->batch_size > 0 ? static_cast<size_t>(this->batch_size) : 1;
+    std::vector<T> out(us_BlockSize * us_OutputSize);
+    std::vector<int> actions(us_BlockSize);
+    std::vector<Network> nn(1);
+    std::vector<PositionSimulator<Market>> simulators(
+            1, PositionSimulator<Market>(Market(this->leverage, this->exposure, this->fee), this->capital));
+    cann::optimization_report s_Report = cann::optimization_report();
+
+    createNetwork(nn[0], s_Genome, s_Report);
+    simulate(nn, simulators, 1, s_Data, 0, s_Data.GetRows(), us_OutputSize, out, actions);
+
+    return simulators[0].GetPosition().i_Actions > 0 ? getFitness(simulators[0]) : -300.0;
+}
+
+template<class Market>
+template<typename T>
+TradeReport BacktestEval<Market>::report(BacktestEval p_Eval, cneat::genome &s_Genome, const WindowView<T> &s_Data,
+                                         size_t us_OutputSize, std::vector<TradeLogEntry> &v_Log) {
+    if (p_Eval.recurrent) {
+        return p_Eval.reportGenome(s_Genome, s_Data, us_OutputSize, v_Log, cann::basic_recurrent_network<T>());
+    }
 
-    // kill position
-    quantity = 0.f;
-    open_price = 0.f;
+    return p_Eval.reportFeedForward(s_Genome, s_Data, us_OutputSize, v_Log);
 }
 
-void ForexEval::buyShort(double &current_money, double &quantity, double &open_price, double &close) {
-    // Always sell 0.5 Lots TODO: Make it dynamic
-    quantity = (((current_money * this->exposure) * this->leverage) / 100000) * -1;
-    open_price = close;
+template<class Market>
+template<typename T>
+TradeReport BacktestEval<Market>::reportFeedForward(cneat::genome &s_Genome, const WindowView<T> &s_Data,
+                                                    size_t us_OutputSize, std::vector<TradeLogEntry> &v_Log) {
+    return reportGenome(s_Genome, s_Data, us_OutputSize, v_Log, cann::basic_feed_forward_network<T>());
 }
 
-void ForexEval::sellShort(double &current_money, double &quantity, double &open_price, double &close) {
-    // get how much we won or lost
-    current_money += ((open_price - close) * (100000.f * (quantity * -1.f)));
+template<class Market>
+TradeReport BacktestEval<Market>::reportFeedForward(cneat::genome &s_Genome, const WindowView<double> &s_Data,
+                                                    size_t us_OutputSize, std::vector<TradeLogEntry> &v_Log) {
+    // One genome over all rows, compiling it pays off
+    if (this->engine == 2 && !this->native_cache.empty()) {
+        return reportGenome(s_Genome, s_Data, us_OutputSize, v_Log, cann::compiled_network(this->native_cache));
+    }
+
+    return reportGenome(s_Genome, s_Data, us_OutputSize, v_Log, cann::basic_feed_forward_network<double>());
+}
 
-    // Kill Position
-    quantity = 0.f;
-    open_price = 0.f;
+template<class Market>
+template<class Network, typename T>
+TradeReport BacktestEval<Market>::reportGenome(cneat::genome &s_Genome, const WindowView<T> &s_Data,
+                                               size_t us_OutputSize, std::vector<TradeLogEntry> &v_Log,
+                                               const Network &s_Network) {
+    size_t us_BlockSize = this->batch_size > 0 ? static_cast<size_t>(this->batch_size) : 1;
+    std::vector<T> out(us_BlockSize * us_OutputSize);
+    std::vector<int> actions(us_BlockSize);
+    std::vector<Network> nn(1, s_Network);
+    std::vector<PositionSimulator<Market, TradeLog>> simulators(
+            1, PositionSimulator<Market, TradeLog>(Market(this->leverage, this->exposure, this->fee), this->capital));
+    cann::optimization_report s_Report = cann::optimization_report();
+
+    createNetwork(nn[0], s_Genome, s_Report);
+    simulate(nn, simulators, 1, s_Data, 0, s_Data.GetRows(), us_OutputSize, out, actions);
+
+    const PositionSimulator<Market, TradeLog> &s_Simulator = simulators[0];
+    v_Log = s_Simulator.GetLog().GetEntries();
+
+    return {s_Simulator.GetPosition().i_Actions > 0 ? getFitness(s_Simulator) : -300.0,
+            s_Simulator.GetProfit(),
+            s_Simulator.GetSharpe(),
+            s_Simulator.GetMaxDrawdown(),
+            s_Simulator.GetWinRate(),
+            s_Simulator.GetExposure(),
+            s_Simulator.GetMetrics().i_Trades};
 }
 
 /**************************************************************************************
- * Check Liquidation
- * -----------------
- * Check if position margin is insufficient for sustaining position.
+ * Precision
+ * ---------
+ * Compare the actions of a genome in float and in double.
  **************************************************************************************/
 
-void ForexEval::checkLiquidation(double &current_money, double &quantity, double &open_price, double &close) {
-    if (quantity > 0.f && ((close - open_price) * (100000.f * quantity)) > (current_money / 2.f)) {
-        // get how much we won or lost
-        current_money += ((close - open_price) * (100000.f * quantity));
-
-        // kill position
-        quantity = 0.f;
-        open_price = 0.f;
-    } else if (quantity < 0.f && ((close - open_price) * (100000.f * quantity)) > (current_money / 2.f)) {
-        // get how much we won or lost
-        current_money += ((close - open_price) * (100000.f * quantity));
-
-        // kill position
-        quantity = 0.f;
-        open_price = 0.f;
+template<class Market>
+size_t BacktestEval<Market>::countActionMismatches(BacktestEval p_Eval, cneat::genome &s_Genome,
+                                                   const WindowView<double> &s_Data, const WindowView<float> &s_DataF,
+                                                   size_t us_OutputSize) {
+    size_t datasize = std::min(s_Data.GetRows(), s_DataF.GetRows());
+    size_t us_BlockSize = p_Eval.batch_size > 0 ? static_cast<size_t>(p_Eval.batch_size) : 1;
+    size_t us_Mismatches = 0;
+
+    std::vector<double> out(us_BlockSize * us_OutputSize);
+    std::vector<float> outF(us_BlockSize * us_OutputSize);
+    std::vector<int> actions(us_BlockSize);
+    std::vector<int> actionsF(us_BlockSize);
+
+    cann::basic_feed_forward_network<double> nn;
+    cann::basic_feed_forward_network<float> nnF;
+    nn.from_genome(s_Genome);
+    nnF.from_genome(s_Genome);
+    nn.set_engine(p_Eval.engine == 2 ? 1 : p_Eval.engine);
+    nnF.set_engine(p_Eval.engine == 2 ? 1 : p_Eval.engine);
+
+    if (p_Eval.optimize) {
+        nn.optimize(p_Eval.prune_weight);
+        nnF.optimize(p_Eval.prune_weight);
     }
-}
 
-/**************************************************************************************
- * Ann / Fitness
- * -------------
- * ANN interaction.
- **************************************************************************************/
+    for (size_t us_BlockStart = 0; us_BlockStart < datasize; us_BlockStart += us_BlockSize) {
+        size_t us_Count = std::min(us_BlockSize, datasize - us_BlockStart);
 
-int ForexEval::getAction(cann::feed_forward_network &FFN, std::vector<double> &dataRow, std::vector<double> &vec_out) {
-    FFN.activate(dataRow, vec_out);
+        p_Eval.getActions(nn, s_Data.GetRow(us_BlockStart), us_Count, s_Data.GetStride(), us_OutputSize,
+                          out.data(), actions.data());
+        p_Eval.getActions(nnF, s_DataF.GetRow(us_BlockStart), us_Count, s_DataF.GetStride(), us_OutputSize,
+                          outF.data(), actionsF.data());
 
-    // get action: 1 == long ; -1 == short; 0 == nothing
-    if (vec_out[0] > 0.5 && vec_out[1] < 0.5) {
-        return 1;
-    } else if (vec_out[0] < 0.5 && vec_out[1] > 0.5) {
-        return -1;
+        for (size_t us_it = 0; us_it < us_Count; us_it++) {
+            if (actions[us_it] != actionsF[us_it]) {
+                ++us_Mismatches;
+            }
+        }
     }
 
-    return 0;
+    return us_Mismatches;
+}
+
+template<class Market>
+int BacktestEval<Market>::getPrecision() const noexcept {
+    return precision;
 }
 
-double ForexEval::getFitness(double &current_money, double &starting_money, int num_act) {
-    // Get fitness
-    double fitness = current_money - starting_money;
-    fitness = fitness / starting_money;
-    fitness = fitness * 100.f;
+template<class Market>
+int BacktestEval<Market>::getMarket() const noexcept {
+    return market;
+}
 
-    // If numact == 0 ==> set fitness to -300
-    if (num_act == 0) {
-        fitness = -300.f;
+template<class Market>
+double BacktestEval<Market>::getAssetFitness(const std::vector<double> &v_Fitness) const noexcept {
+    if (v_Fitness.empty()) {
+        return -300.0;
     }
 
-    return fitness;
+    if (asset_fitness == 1) {
+        return *std::min_element(v_Fitness.begin(), v_Fitness.end());
+    }
+
+    return std::accumulate(v_Fitness.begin(), v_Fitness.end(), 0.0) / v_Fitness.size();
+}
+
+template<class Market>
+bool BacktestEval<Market>::isRecurrent() const noexcept {
+    return recurrent != 0;
 }
 
+template<class Market>
+bool BacktestEval<Market>::isValidating() const noexcept {
+    return validate != 0;
+}
 
+template<class Market>
+size_t BacktestEval<Market>::getFitnessCache() const noexcept {
+    return fitness_cache > 0 ? static_cast<size_t>(fitness_cache) : 0;
+}
 
+template<class Market>
+size_t BacktestEval<Market>::getPhenotypeCache() const noexcept {
+    return phenotype_cache > 0 ? static_cast<size_t>(phenotype_cache) : 0;
+}
 
-/***********************************************************************************************************************
- *
- *
- * Definitions for class CryptoEval
- *
- *
- ***********************************************************************************************************************/
+template<class Market>
+bool BacktestEval<Market>::isLargestFirst() const noexcept {
+    return schedule == 1;
+}
 
+template<class Market>
+size_t BacktestEval<Market>::getLockstep() const noexcept {
+    return this->lockstep > 1 ? static_cast<size_t>(this->lockstep) : 1;
+}
+
+template<class Market>
+void BacktestEval<Market>::getRacing(size_t &us_Segments, double &f64_Promotion) const noexcept {
+    // The state of a recurrent network is not kept between segments, mini-batches are not raced
+    us_Segments = race_segments > 1 && recurrent == 0 && minibatch_windows <= 0 ? static_cast<size_t>(race_segments) : 1;
+    f64_Promotion = race_promotion;
+}
+
+template<class Market>
+void BacktestEval<Market>::getMiniBatch(size_t &us_Windows, size_t &us_Rows, size_t &us_Check) const noexcept {
+    us_Windows = minibatch_windows > 0 ? static_cast<size_t>(minibatch_windows) : 0;
+    us_Rows = minibatch_rows > 0 ? static_cast<size_t>(minibatch_rows) : 1;
+    us_Check = minibatch_check > 0 ? static_cast<size_t>(minibatch_check) : 0;
+}
 
 /**************************************************************************************
- * evaluate
- * --------------
- * Evaluate pool genomes with crypto dataset.
+ * Setters
+ * -------
+ * BacktestEval setters.
  **************************************************************************************/
 
-void CryptoEval::evaluate(CryptoEval p_cryptoEval, TraderPool *p_Pool, ThreadSync *p_ThreadSync,
-                          std::vector<std::vector<double>> &v_Data, bool b_MainThread)
-{
-    // Needed Variables
-    double starting_money = p_cryptoEval.capital;
-    double current_money = starting_money;
-    double quantity = 0;
-    double open_price;
-    double liq_level = 0;
-    double pos_value = 0;
-    int action;
-    double tradefee;
-    int numact = 0;
-    double close;
-    double fitness;
-
-    //long vars
-    double buy_units;
-    double total_buy;
-    double buyvalue;
-
-    //short vars
-    double sell_units;
-    double total_sell;
-    double sellvalue;
-
-    size_t datasize = v_Data.size();
-    std::vector<double> out;
-    cneat::genome *working_genome;
-    cann::feed_forward_network nn;
-
-    do {
-        if (!b_MainThread) {
-            // Wait for available data
-            p_ThreadSync->WaitForSignal();
-
-            // Thread kill
-            if (p_ThreadSync->GetKillThreads()) {
-                return;
-            }
-        } else {
-            // Signal other threads
-            p_ThreadSync->NotifyWaiting();
+template<class Market>
+void BacktestEval<Market>::setNativeCache(const std::string &s_Directory) {
+    native_cache = s_Directory;
+}
+
+/**************************************************************************************
+ * Ann / Fitness
+ * -------------
+ * ANN interaction.
+ **************************************************************************************/
+
+template<class Market>
+template<typename T>
+int BacktestEval<Market>::getAction(cann::basic_feed_forward_network<T> &FFN, const T *dataRow, std::vector<T> &vec_out) {
+    FFN.activate(dataRow, vec_out.data());
+
+    return decodeAction(vec_out.data());
+}
+
+template<class Market>
+template<typename T>
+void BacktestEval<Market>::getActions(cann::basic_feed_forward_network<T> &FFN, const T *p_Rows, size_t us_Count, ptrdiff_t i_Stride,
+                                      size_t us_OutputSize, T *p_Out, int *p_Actions) {
+    if (this->batch_size > 0) {
+        FFN.activate_batch(p_Rows, us_Count, i_Stride, p_Out);
+    } else {
+        for (size_t us_it = 0; us_it < us_Count; us_it++) {
+            FFN.activate(p_Rows + static_cast<ptrdiff_t>(us_it) * i_Stride, p_Out + us_it * us_OutputSize);
         }
+    }
 
-        // Work on pool
-        while ((working_genome = p_Pool->GetNextGenome()) != NULL) {
-            // Create ANN
-            nn.from_genome(*working_genome);
-
-            // Simulate Trading
-            starting_money = p_cryptoEval.capital;
-            current_money = starting_money;
-            quantity = 0;
-            liq_level = 0;
-            pos_value = 0;
-            numact = 0;
-
-            // Backtesting
-            for (unsigned int it = 0; it < datasize; it++) {
-                close = v_Data[it][3];
-
-                // get action from ann
-                nn.activate(v_Data[it], out);
-
-                // get action: 1 == long ; -1 == short; 0 == nothing
-                if (out[0] > 0.5 && out[1] < 0.5) {
-                    action = 1;
-                } else if (out[0] < 0.5 && out[1] > 0.5) {
-                    action = -1;
-                } else {
-                    action = 0;
-                }
+    for (size_t us_it = 0; us_it < us_Count; us_it++) {
+        p_Actions[us_it] = decodeAction(p_Out + us_it * us_OutputSize);
+    }
+}
 
-                // Check if money is available
-                if (current_money <= 0) {
-                    current_money = 0;
-                    break;
-                }
+template<class Market>
+void BacktestEval<Market>::getActions(cann::compiled_network &CN, const double *p_Rows, size_t us_Count, ptrdiff_t i_Stride,
+                                      size_t us_OutputSize, double *p_Out, int *p_Actions) {
+    for (size_t us_it = 0; us_it < us_Count; us_it++) {
+        CN.activate(p_Rows + static_cast<ptrdiff_t>(us_it) * i_Stride, p_Out + us_it * us_OutputSize);
+        p_Actions[us_it] = decodeAction(p_Out + us_it * us_OutputSize);
+    }
+}
 
-                // check for Liquidations
-                if (quantity < 0 && liq_level < close) {
-                    // substract liquidation fee
-                    tradefee = quantity * close;
-                    tradefee = tradefee * p_cryptoEval.fee;
-                    current_money -= tradefee;
-
-                    // Kill Position
-                    quantity = 0;
-                    liq_level = 0;
-                    open_price = 0;
-                } else if (quantity > 0 && close < liq_level) {
-                    // substract liquidation fee
-                    tradefee = quantity * close;
-                    tradefee = tradefee * p_cryptoEval.fee;
-                    current_money -= tradefee;
-
-                    // Kill position
-                    quantity = 0;
-                    liq_level = 0;
-                    open_price = 0;
-                }
+template<class Market>
+template<typename T>
+void BacktestEval<Market>::getActions(cann::basic_recurrent_network<T> &RNN, const T *p_Rows, size_t us_Count, ptrdiff_t i_Stride,
+                                      size_t us_OutputSize, T *p_Out, int *p_Actions) {
+    // One step per row, the state carries over to the next block
+    for (size_t us_it = 0; us_it < us_Count; us_it++) {
+        RNN.activate(p_Rows + static_cast<ptrdiff_t>(us_it) * i_Stride, p_Out + us_it * us_OutputSize);
+        p_Actions[us_it] = decodeAction(p_Out + us_it * us_OutputSize);
+    }
+}
 
-                // IF ACTION == LONG
-                if (action == 1) {
-                    numact += 1;
-
-                    if (quantity == 0) {
-                        // Open new Long position if there is no current position
-                        // Units to buy
-                        buy_units = current_money * p_cryptoEval.exposure;
-                        buy_units = buy_units / close;
-                        // Price of position
-                        total_buy = buy_units * close;
-                        current_money -= total_buy;
-                        pos_value = total_buy;
-                        // trade fee
-                        tradefee = total_buy * p_cryptoEval.fee;
-                        tradefee = tradefee * p_cryptoEval.leverage;
-                        current_money -= tradefee;
-                        // actualize quantity and open price
-                        quantity = buy_units * p_cryptoEval.leverage;
-                        open_price = close;
-                    } else if (quantity < 0) {
-                        // Sell Shortposition if there is one
-                        // Get how much you get back from selling the position
-                        buyvalue = close - open_price;
-                        buyvalue = buyvalue * quantity;
-                        buyvalue = pos_value + buyvalue;
-                        current_money += buyvalue;
-
-                        // Kill Position
-                        quantity = 0;
-                        open_price = 0;
-                        pos_value = 0;
-                    }
-                }
+template<class Market>
+template<typename T>
+void BacktestEval<Market>::createNetwork(cann::basic_feed_forward_network<T> &FFN, cneat::genome &s_Genome,
+                                         cann::optimization_report &s_Report) {
+    FFN.from_genome(s_Genome);
+    FFN.set_engine(this->engine == 2 ? 1 : this->engine);
+
+    if (this->optimize) {
+        cann::optimization_report s_Optimized = FFN.optimize(this->prune_weight);
+        s_Report.nodes_before += s_Optimized.nodes_before;
+        s_Report.nodes_after += s_Optimized.nodes_after;
+        s_Report.links_before += s_Optimized.links_before;
+        s_Report.links_after += s_Optimized.links_after;
+        s_Report.constants_folded += s_Optimized.constants_folded;
+        s_Report.links_merged += s_Optimized.links_merged;
+    }
+}
 
-                    // If ANN Shorts
-                else if (action == -1) {
-                    numact += 1;
-
-                    if (quantity == 0) {
-                        // Open new Short Position
-                        // Units to sell
-                        sell_units = current_money * p_cryptoEval.exposure;
-                        sell_units = sell_units / close;
-
-                        // Price of Position
-                        total_sell = sell_units * close;
-                        current_money -= total_sell;
-                        pos_value = 0 - sell_units;
-
-                        // tradefee
-                        tradefee = total_sell * p_cryptoEval.fee;
-                        tradefee = tradefee * p_cryptoEval.leverage;
-                        current_money -= tradefee;
-
-                        // actualize quantity and open_price
-                        quantity = 0 - sell_units;
-                        open_price = close;
-                    } else if (quantity > 0) {
-                        // Get how much you get back from selling the position
-                        sellvalue = close - open_price;
-                        sellvalue = sellvalue * quantity;
-                        sellvalue = pos_value + sellvalue;
-                        current_money += sellvalue;
-
-                        // Kill Position
-                        quantity = 0;
-                        open_price = 0;
-                        pos_value = 0;
-                    }
-                }
-            }
+template<class Market>
+void BacktestEval<Market>::createNetwork(cann::compiled_network &CN, cneat::genome &s_Genome,
+                                         cann::optimization_report &s_Report) {
+    if (!this->optimize) {
+        CN.from_genome(s_Genome);
+        return;
+    }
 
-            // Get fitness
-            fitness = current_money - starting_money;
-            fitness = fitness / starting_money;
-            fitness = fitness * 100;
+    cann::optimization_report s_Optimized = CN.from_genome(s_Genome, this->prune_weight);
+    s_Report.nodes_before += s_Optimized.nodes_before;
+    s_Report.nodes_after += s_Optimized.nodes_after;
+    s_Report.links_before += s_Optimized.links_before;
+    s_Report.links_after += s_Optimized.links_after;
+    s_Report.constants_folded += s_Optimized.constants_folded;
+    s_Report.links_merged += s_Optimized.links_merged;
+}
 
-            // If numact == 0 ==> set fitness to -300
-            if (numact == 0) {
-                fitness = -300;
-            }
+template<class Market>
+template<typename T>
+void BacktestEval<Market>::createNetwork(cann::basic_recurrent_network<T> &RNN, cneat::genome &s_Genome,
+                                         cann::optimization_report &) {
+    // Starts with all node states at 0.0, optimize() folds across steps and is not used
+    RNN.from_genome(s_Genome);
+}
 
-            // Write fitness
-            working_genome->fitness = fitness;
-        }
-    } while (!b_MainThread);
+template<class Market>
+template<typename T>
+void BacktestEval<Market>::resetNetwork(cann::basic_feed_forward_network<T> &) {
+    // No state between rows
+}
+
+template<class Market>
+template<typename T>
+void BacktestEval<Market>::resetNetwork(cann::basic_recurrent_network<T> &RNN) {
+    RNN.reset();
+}
+
+template<class Market>
+template<typename T>
+int BacktestEval<Market>::decodeAction(const T *p_Out) {
+    // get action: 1 == long ; -1 == short; 0 == nothing
+    if (p_Out[0] > 0.5 && p_Out[1] < 0.5) {
+        return 1;
+    } else if (p_Out[0] < 0.5 && p_Out[1] > 0.5) {
+        return -1;
+    }
+
+    return 0;
+}
+
+template<class Market>
+template<class Simulator>
+double BacktestEval<Market>::getFitness(const Simulator &s_Simulator) const noexcept {
+    double f64_Fitness = s_Simulator.GetProfit();
+
+    // Skipped at 0.0, the metrics of a blown up forex account may not be finite
+    if (fitness_sharpe != 0.0) {
+        f64_Fitness += fitness_sharpe * s_Simulator.GetSharpe();
+    }
+    if (fitness_drawdown != 0.0) {
+        f64_Fitness -= fitness_drawdown * s_Simulator.GetMaxDrawdown() * 100.0;
+    }
+    if (fitness_winrate != 0.0) {
+        f64_Fitness += fitness_winrate * s_Simulator.GetWinRate() * 100.0;
+    }
+    if (fitness_exposure != 0.0) {
+        f64_Fitness += fitness_exposure * s_Simulator.GetExposure() * 100.0;
+    }
+
+    return f64_Fitness;
 }
+
+// Markets and scalar types of the dataset
+template class BacktestEval<ForexMarket>;
+template class BacktestEval<CryptoMarket>;
+template void ForexEval::evaluate<double>(ForexEval, TraderPool *, const std::vector<WindowView<double>> &);
+template void ForexEval::evaluate<float>(ForexEval, TraderPool *, const std::vector<WindowView<float>> &);
+template double ForexEval::score<double>(ForexEval, cneat::genome &, const WindowView<double> &, size_t);
+template double ForexEval::score<float>(ForexEval, cneat::genome &, const WindowView<float> &, size_t);
+template TradeReport ForexEval::report<double>(ForexEval, cneat::genome &, const WindowView<double> &, size_t,
+                                               std::vector<TradeLogEntry> &);
+template void CryptoEval::evaluate<double>(CryptoEval, TraderPool *, const std::vector<WindowView<double>> &);
+template void CryptoEval::evaluate<float>(CryptoEval, TraderPool *, const std::vector<WindowView<float>> &);
+template double CryptoEval::score<double>(CryptoEval, cneat::genome &, const WindowView<double> &, size_t);
+template double CryptoEval::score<float>(CryptoEval, cneat::genome &, const WindowView<float> &, size_t);
+template TradeReport CryptoEval::report<double>(CryptoEval, cneat::genome &, const WindowView<double> &, size_t,
+                                                std::vector<TradeLogEntry> &);
@@ -16,11 +16,37 @@
 
 // Project
 #include "./TraderPool.hpp"
-#include "./ThreadSync.hpp"
 #include "./cann.h"
+#include "./cann_recurrent.h"
+#include "./cann_compiled.h"
+#include "./cann_cache.h"
+#include "./WindowView.hpp"
+#include "./PositionSimulator.hpp"
+
+
+/**
+ *  Trade metrics of a genome backtested on all rows, see BacktestEval::report().
+ */
+
+struct TradeReport {
+    double f64_Fitness;
+    double f64_Profit; // Percent of the starting money
+    double f64_Sharpe; // Of the equity returns per candle over the whole backtest
+    double f64_MaxDrawdown; // 0.1 == 10%
+    double f64_WinRate; // Part of the trades which gained equity
+    double f64_Exposure; // Part of the candles with an open position
+    int i_Trades;
+};
+
 
+/**
+ *  Backtest of the genomes of a pool on a dataset.
+ *  Market is the TradingMarket the accounts are simulated with. Its fee, liquidation and
+ *  sizing policies are inlined into the loop of every instantiation, see ForexEval and CryptoEval.
+ */
 
-class ForexEval {
+template<class Market>
+class BacktestEval {
 public:
 
     /**********************************************************************************************
@@ -30,188 +56,183 @@ public:
     /**
      *  Default constructor.
      */
-    ForexEval() noexcept;
+    BacktestEval() noexcept;
 
     /**
      *  Default destructor.
      */
-    ~ForexEval() noexcept;
+    ~BacktestEval() noexcept;
 
     /**********************************************************************************************
      * EvalFunction
      **********************************************************************************************/
 
     /**
-     *  Evaluate.
+     *  Evaluate race entries of the pool until the rung has none left, called by every
+     *  thread of a WorkerPool.
      *
-     *  \param p_ForexEval ForexEval class object.
+     *  \param p_Eval BacktestEval class object.
      *  \param p_Pool Trader pool class object.
-     *  \param p_ThreadSync Thread snyc class object.
-     *  \param v_Data Trading data reference.
-     *  \param b_MainThread Use main thread.
+     *  \param v_Data Trading data of every asset, input rows of the networks and close prices.
+     *
+     *  T is the scalar type of the dataset and the networks, double or float.
      */
 
-    static void evaluate(ForexEval p_ForexEval, TraderPool *p_Pool, ThreadSync *p_ThreadSync,
-                         std::vector<std::vector<double>> &v_Data, bool b_MainThread);
-
-    /**********************************************************************************************
-     * Serialize
-     **********************************************************************************************/
+    template<typename T>
+    static void evaluate(BacktestEval p_Eval, TraderPool *p_Pool, const std::vector<WindowView<T>> &v_Data);
 
     /**
-     *  Serialize with cereal.
+     *  Backtest a single genome on all rows, e.g. to score a genome evolved on mini-batches.
      *
-     *  \param s_Archive The archive to use.
+     *  \param p_Eval BacktestEval class object.
+     *  \param s_Genome The genome.
+     *  \param s_Data Trading data.
+     *  \param us_OutputSize Outputs of the genome.
+     *
+     *  \return The fitness.
      */
 
-    template<class Archive>
-    void serialization(Archive &s_Archive) {
-        s_Archive(CEREAL_NVP(outputs),
-                  CEREAL_NVP(capital),
-                  CEREAL_NVP(leverage),
-                  CEREAL_NVP(exposure),
-                  CEREAL_NVP(fee));
-    }
+    template<typename T>
+    static double score(BacktestEval p_Eval, cneat::genome &s_Genome, const WindowView<T> &s_Data,
+                        size_t us_OutputSize);
 
-private:
+    /**
+     *  Backtest a single genome on all rows and record every candle, e.g. for the winner.
+     *  With engine 2 a feed forward network in double runs as native code, see setNativeCache().
+     *
+     *  \param p_Eval BacktestEval class object.
+     *  \param s_Genome The genome.
+     *  \param s_Data Trading data.
+     *  \param us_OutputSize Outputs of the genome.
+     *  \param v_Log Set to the action, close, position and equity of every candle.
+     *
+     *  \return The fitness and the trade metrics.
+     */
 
-    /**********************************************************************************************
-     * Contract Buy / Sell contract
-     **********************************************************************************************/
+    template<typename T>
+    static TradeReport report(BacktestEval p_Eval, cneat::genome &s_Genome, const WindowView<T> &s_Data,
+                              size_t us_OutputSize, std::vector<TradeLogEntry> &v_Log);
 
     /**
-     *  Buy Long contract at current price.
+     *  Count the rows on which the actions of a genome differ between a float and a double network.
+     *
+     *  \param p_Eval BacktestEval class object.
+     *  \param s_Genome The genome.
+     *  \param s_Data Trading data in double.
+     *  \param s_DataF The same trading data in float.
+     *  \param us_OutputSize Outputs of the genome.
      *
-     *  \param quantity Quantity reference.
-     *  \param open_price Open price reference.
-     *  \param close Close reference.
+     *  \return Number of rows with a different action.
      */
 
-    inline void buyLong(double &current_money, double &quantity, double &open_price, double &close);
+    static size_t countActionMismatches(BacktestEval p_Eval, cneat::genome &s_Genome, const WindowView<double> &s_Data,
+                                        const WindowView<float> &s_DataF, size_t us_OutputSize);
 
     /**
-     *  Sell Long contract and kill position.
+     *  Get the precision setting.
      *
-     *  \param current_money Current money reference.
-     *  \param quantity Quantity reference.
-     *  \param open_price Open price reference.
-     *  \param close Close reference.
+     *  \return Bits of the dataset and network scalars, 64 or 32.
      */
 
-    inline void sellLong(double &current_money, double &quantity, double &open_price, double &close);
+    int getPrecision() const noexcept;
 
     /**
-     *  Buy Short contract at current price.
+     *  Get the market setting.
      *
-     *  \param quantity Quantity reference.
-     *  \param open_price Open price reference.
-     *  \param close Close reference.
+     *  \return 0 == forex lots (ForexEval), 1 == crypto margin (CryptoEval).
      */
 
-    inline void buyShort(double &current_money, double &quantity, double &open_price, double &close);
+    int getMarket() const noexcept;
 
     /**
-     *  Sell Short contract and kill position.
+     *  Get the fitness of a genome evaluated on several datasets.
      *
-     *  \param current_money Current money reference.
-     *  \param quantity Quantity reference.
-     *  \param open_price Open price reference.
-     *  \param close Close reference.
+     *  \param v_Fitness The fitness on every dataset.
+     *
+     *  \return The mean or the minimum, see asset_fitness.
      */
 
-    inline void sellShort(double &current_money, double &quantity, double &open_price, double &close);
-
-    /**********************************************************************************************
-     * Liquidation
-     **********************************************************************************************/
+    double getAssetFitness(const std::vector<double> &v_Fitness) const noexcept;
 
     /**
-     *  Check if position margin is insufficient for sustaining position.
-     *  The position is killed if the requirement is met.
+     *  Get the recurrent setting.
      *
-     *  \param current_money Current money reference.
-     *  \param quantity Quantity reference.
-     *  \param open_price Open price reference.
-     *  \param close Close reference.  
+     *  \return True if genomes are evaluated as recurrent networks, one candle per step.
      */
 
-    inline void checkLiquidation(double &current_money, double &quantity, double &open_price, double &close);
-
-    /**********************************************************************************************
-     * Ann / Fitness
-     **********************************************************************************************/
+    bool isRecurrent() const noexcept;
 
     /**
-     *  Get action from ANN.
+     *  Get the validation setting.
      *
-     *  \param FFN FFN reference.
-     *  \param dataRow Data row reference.
-     *  \param vec_out Output vector reference.
-     *
-     *  \return The action from the ANN.
+     *  \return True if new best genomes are validated in the background.
      */
 
-    inline int getAction(cann::feed_forward_network &FFN, std::vector<double> &dataRow, std::vector<double> &vec_out);
+    bool isValidating() const noexcept;
 
     /**
-     *  Get fitness from ANN.
+     *  Get the fitness cache setting.
      *
-     *  \param current_money Current money reference.
-     *  \param starting_money Starting money reference.
-     *  \param num_act The ANN action.
-     *
-     *  \return The fitness from the ANN.
+     *  \return Genomes whose fitness is kept for the run, 0 == off.
      */
 
-    inline double getFitness(double &current_money, double &starting_money, int num_act);
+    size_t getFitnessCache() const noexcept;
 
-    /**********************************************************************************************
-     * Data
-     **********************************************************************************************/
+    /**
+     *  Get the phenotype cache setting.
+     *
+     *  \return Phenotypes kept per network type, 0 == off, see TraderPool::SetPhenotypeCache().
+     */
 
-    // Settings
-    int outputs;
-    double capital;
-    int leverage;
-    double exposure;
-    double fee;
+    size_t getPhenotypeCache() const noexcept;
 
-protected:
+    /**
+     *  Get the scheduling setting.
+     *
+     *  \return True if the largest genomes are evaluated first, see TraderPool::SetScheduling().
+     */
 
-};
+    bool isLargestFirst() const noexcept;
 
-class CryptoEval // TODO: implemet remaining functions
-{
-/**********************************************************************************************
-     * Constructor / Destructor
-     **********************************************************************************************/
+    /**
+     *  Get the lockstep setting.
+     *
+     *  \return Genomes per thread stepped through the rows together, at least 1.
+     */
+
+    size_t getLockstep() const noexcept;
 
     /**
-     *  Default constructor.
+     *  Get the racing settings.
+     *
+     *  \param us_Segments Set to the segments of the dataset, 1 == no racing.
+     *  \param f64_Promotion Set to the part of the genomes promoted to the next segment.
      */
-    CryptoEval() noexcept;
+
+    void getRacing(size_t &us_Segments, double &f64_Promotion) const noexcept;
 
     /**
-     *  Default destructor.
+     *  Get the mini-batch settings.
+     *
+     *  \param us_Windows Set to the windows drawn per generation, 0 == all rows.
+     *  \param us_Rows Set to the rows per window.
+     *  \param us_Check Set to the generations between checks against all rows, 0 == never.
      */
-    ~CryptoEval() noexcept;
+
+    void getMiniBatch(size_t &us_Windows, size_t &us_Rows, size_t &us_Check) const noexcept;
 
     /**********************************************************************************************
-     * EvalFunction
+     * Setters
      **********************************************************************************************/
 
     /**
-     *  Evaluate.
+     *  Set the directory of the shared objects built for engine 2, created on first use.
+     *  Without one the report runs the bytecode.
      *
-     *  \param p_ForexEval ForexEval class object.
-     *  \param p_Pool Trader pool class object.
-     *  \param p_ThreadSync Thread snyc class object.
-     *  \param v_Data Trading data reference.
-     *  \param b_MainThread Use main thread.
+     *  \param s_Directory The directory.
      */
 
-    static void evaluate(CryptoEval p_cryptoEval, TraderPool *p_Pool, ThreadSync *p_ThreadSync,
-                         std::vector<std::vector<double>> &v_Data, bool b_MainThread);
+    void setNativeCache(const std::string &s_Directory);
 
     /**********************************************************************************************
      * Serialize
@@ -224,77 +245,128 @@ class CryptoEval // TODO: implemet remaining functions
      */
 
     template<class Archive>
-    void serialization(Archive s_Archive) {
+    void serialization(Archive &s_Archive) {
         s_Archive(CEREAL_NVP(outputs),
                   CEREAL_NVP(capital),
                   CEREAL_NVP(leverage),
                   CEREAL_NVP(exposure),
-                  CEREAL_NVP(fee));
+                  CEREAL_NVP(fee),
+                  CEREAL_NVP(batch_size),
+                  CEREAL_NVP(lockstep),
+                  CEREAL_NVP(engine),
+                  CEREAL_NVP(precision),
+                  CEREAL_NVP(optimize),
+                  CEREAL_NVP(prune_weight),
+                  CEREAL_NVP(recurrent),
+                  CEREAL_NVP(phenotype_cache),
+                  CEREAL_NVP(race_segments),
+                  CEREAL_NVP(race_promotion),
+                  CEREAL_NVP(minibatch_windows),
+                  CEREAL_NVP(minibatch_rows),
+                  CEREAL_NVP(minibatch_check),
+                  CEREAL_NVP(market),
+                  CEREAL_NVP(asset_fitness),
+                  CEREAL_NVP(validate),
+                  CEREAL_NVP(fitness_sharpe),
+                  CEREAL_NVP(fitness_drawdown),
+                  CEREAL_NVP(fitness_winrate),
+                  CEREAL_NVP(fitness_exposure),
+                  CEREAL_NVP(fitness_cache),
+                  CEREAL_NVP(schedule));
     }
 
 private:
 
     /**********************************************************************************************
-     * Contract Buy / Sell contract
+     * Backtest
      **********************************************************************************************/
 
     /**
-     *  Buy Long contract at current price.
+     *  Claim race entries from the pool until the rung is done and backtest them on the
+     *  rows of the rung of their asset, continuing the accounts of the previous one. With
+     *  mini-batch windows set in the pool, the fitness is the mean fitness of the windows instead.
+     *  Per block of rows the networks produce all actions first, then a PositionSimulator
+     *  runs them over the close prices.
      *
-     *  \param quantity Quantity reference.
-     *  \param open_price Open price reference.
-     *  \param close Close reference.
+     *  \param p_Pool Trader pool class object.
+     *  \param v_Data Trading data of every asset.
+     *
+     *  Network is the phenotype, basic_feed_forward_network<T> or basic_recurrent_network<T>.
      */
 
-    inline void buyLong(double &quantity, double &open_price, double &close);
+    template<class Network, typename T>
+    void backtest(TraderPool *p_Pool, const std::vector<WindowView<T>> &v_Data);
 
     /**
-     *  Sell Long contract and kill position.
+     *  Step genomes in lockstep through a range of rows.
+     *
+     *  \param nn The networks.
+     *  \param simulators The accounts, only active ones are stepped.
+     *  \param us_Genomes Genomes in use.
+     *  \param s_Data Trading data.
+     *  \param us_RowBegin First row.
+     *  \param us_RowEnd One past the last row.
+     *  \param us_OutputSize Outputs per row.
+     *  \param out Output buffer of one block of rows, its size sets the block.
+     *  \param actions Action buffer, one block per genome.
      *
-     *  \param current_money Current money reference.
-     *  \param quantity Quantity reference.
-     *  \param open_price Open price reference.
-     *  \param close Close reference.
+     *  Simulator is a PositionSimulator of Market, with or without a trade log.
      */
 
-    inline void sellLong(double &current_money, double &quantity, double &open_price, double &close);
+    template<class Network, class Simulator, typename T>
+    void simulate(std::vector<Network> &nn, std::vector<Simulator> &simulators,
+                  size_t us_Genomes, const WindowView<T> &s_Data, size_t us_RowBegin, size_t us_RowEnd,
+                  size_t us_OutputSize, std::vector<T> &out, std::vector<int> &actions);
 
     /**
-     *  Buy Short contract at current price.
+     *  Backtest a single genome on all rows, see score().
      *
-     *  \param quantity Quantity reference.
-     *  \param open_price Open price reference.
-     *  \param close Close reference.
+     *  \param s_Genome The genome.
+     *  \param s_Data Trading data.
+     *  \param us_OutputSize Outputs of the genome.
+     *
+     *  \return The fitness.
      */
 
-    inline void buyShort(double &quantity, double &open_price, double &close);
+    template<class Network, typename T>
+    double scoreGenome(cneat::genome &s_Genome, const WindowView<T> &s_Data, size_t us_OutputSize);
 
     /**
-     *  Sell Short contract and kill position.
+     *  Backtest a single genome on all rows with a trade log, see report().
+     *
+     *  \param s_Genome The genome.
+     *  \param s_Data Trading data.
+     *  \param us_OutputSize Outputs of the genome.
+     *  \param v_Log Set to the recorded candles.
      *
-     *  \param current_money Current money reference.
-     *  \param quantity Quantity reference.
-     *  \param open_price Open price reference.
-     *  \param close Close reference.
+     *  \return The fitness and the trade metrics.
      */
 
-    inline void sellShort(double &current_money, double &quantity, double &open_price, double &close);
-
-    /**********************************************************************************************
-     * Liquidation
-     **********************************************************************************************/
+    template<class Network, typename T>
+    TradeReport reportGenome(cneat::genome &s_Genome, const WindowView<T> &s_Data, size_t us_OutputSize,
+                             std::vector<TradeLogEntry> &v_Log, const Network &s_Network);
 
     /**
-     *  Check if position margin is insufficient for sustaining position.
-     *  The position is killed if the requirement is met.
+     *  Backtest a single feed forward genome on all rows with a trade log, see report().
+     *
+     *  \param s_Genome The genome.
+     *  \param s_Data Trading data.
+     *  \param us_OutputSize Outputs of the genome.
+     *  \param v_Log Set to the recorded candles.
      *
-     *  \param current_money Current money reference.
-     *  \param quantity Quantity reference.
-     *  \param open_price Open price reference.
-     *  \param close Close reference.
+     *  \return The fitness and the trade metrics.
+     */
+
+    template<typename T>
+    TradeReport reportFeedForward(cneat::genome &s_Genome, const WindowView<T> &s_Data, size_t us_OutputSize,
+                                  std::vector<TradeLogEntry> &v_Log);
+
+    /**
+     *  Same, the network runs as native code with engine 2.
      */
 
-    inline void checkLiquidation(double &current_money, double &quantity, double &open_price, double &close);
+    TradeReport reportFeedForward(cneat::genome &s_Genome, const WindowView<double> &s_Data, size_t us_OutputSize,
+                                  std::vector<TradeLogEntry> &v_Log);
 
     /**********************************************************************************************
      * Ann / Fitness
@@ -304,25 +376,138 @@ private:
      *  Get action from ANN.
      *
      *  \param FFN FFN reference.
-     *  \param dataRow Data row reference.
+     *  \param dataRow Data row.
      *  \param vec_out Output vector reference.
      *
      *  \return The action from the ANN.
      */
 
-    inline int getAction(cann::feed_forward_network &FFN, std::vector<double> &dataRow, std::vector<double> &vec_out);
+    template<typename T>
+    inline int getAction(cann::basic_feed_forward_network<T> &FFN, const T *dataRow, std::vector<T> &vec_out);
+
+    /**
+     *  Get the actions for a block of rows from ANN.
+     *  Uses activate_batch if batch_size > 0, else one activate per row.
+     *
+     *  \param FFN FFN reference.
+     *  \param p_Rows First data row.
+     *  \param us_Count Number of rows.
+     *  \param i_Stride Distance between two rows, see WindowView.
+     *  \param us_OutputSize Outputs per row.
+     *  \param p_Out Output buffer, at least us_Count * us_OutputSize values.
+     *  \param p_Actions Action buffer, at least us_Count values.
+     */
+
+    template<typename T>
+    inline void getActions(cann::basic_feed_forward_network<T> &FFN, const T *p_Rows, size_t us_Count, ptrdiff_t i_Stride,
+                           size_t us_OutputSize, T *p_Out, int *p_Actions);
+
+    /**
+     *  Get the actions for a block of rows from a native ANN, one activate per row.
+     *
+     *  \param CN Compiled network reference.
+     *  \param p_Rows First data row.
+     *  \param us_Count Number of rows.
+     *  \param i_Stride Distance between two rows, see WindowView.
+     *  \param us_OutputSize Outputs per row.
+     *  \param p_Out Output buffer, at least us_Count * us_OutputSize values.
+     *  \param p_Actions Action buffer, at least us_Count values.
+     */
+
+    inline void getActions(cann::compiled_network &CN, const double *p_Rows, size_t us_Count, ptrdiff_t i_Stride,
+                           size_t us_OutputSize, double *p_Out, int *p_Actions);
+
+    /**
+     *  Get the actions for a block of rows from a recurrent ANN, one step per row.
+     *
+     *  \param RNN RNN reference.
+     *  \param p_Rows First data row.
+     *  \param us_Count Number of rows.
+     *  \param i_Stride Distance between two rows, see WindowView.
+     *  \param us_OutputSize Outputs per row.
+     *  \param p_Out Output buffer, at least us_Count * us_OutputSize values.
+     *  \param p_Actions Action buffer, at least us_Count values.
+     */
+
+    template<typename T>
+    inline void getActions(cann::basic_recurrent_network<T> &RNN, const T *p_Rows, size_t us_Count, ptrdiff_t i_Stride,
+                           size_t us_OutputSize, T *p_Out, int *p_Actions);
+
+    /**
+     *  Create the ANN of a genome.
+     *
+     *  \param FFN FFN reference.
+     *  \param s_Genome The genome.
+     *  \param s_Report Optimization report, the result of optimize() is added.
+     */
+
+    template<typename T>
+    inline void createNetwork(cann::basic_feed_forward_network<T> &FFN, cneat::genome &s_Genome,
+                              cann::optimization_report &s_Report);
+
+    /**
+     *  Compile the ANN of a genome to native code, or load it from the cache.
+     *
+     *  \param CN Compiled network reference.
+     *  \param s_Genome The genome.
+     *  \param s_Report Optimization report, the result of optimize() is added.
+     */
+
+    inline void createNetwork(cann::compiled_network &CN, cneat::genome &s_Genome,
+                              cann::optimization_report &s_Report);
+
+    /**
+     *  Create the recurrent ANN of a genome.
+     *
+     *  \param RNN RNN reference.
+     *  \param s_Genome The genome.
+     *  \param s_Report Optimization report, unchanged.
+     */
+
+    template<typename T>
+    inline void createNetwork(cann::basic_recurrent_network<T> &RNN, cneat::genome &s_Genome,
+                              cann::optimization_report &s_Report);
+
+    /**
+     *  Reset the state of an ANN, nothing for a feed forward one.
+     *
+     *  \param FFN FFN reference.
+     */
+
+    template<typename T>
+    inline void resetNetwork(cann::basic_feed_forward_network<T> &FFN);
 
     /**
-     *  Get fitness from ANN.
+     *  Reset the node states of a recurrent ANN to 0.0.
      *
-     *  \param current_money Current money reference.
-     *  \param starting_money Starting money reference.
-     *  \param num_act The ANN action.
+     *  \param RNN RNN reference.
+     */
+
+    template<typename T>
+    inline void resetNetwork(cann::basic_recurrent_network<T> &RNN);
+
+    /**
+     *  Decode the ANN outputs to an action.
+     *
+     *  \param p_Out The outputs of one row.
      *
-     *  \return The fitness from the ANN.
+     *  \return 1 == long ; -1 == short; 0 == nothing
      */
 
-    inline double getFitness(double &current_money, double &starting_money, int num_act);
+    template<typename T>
+    inline int decodeAction(const T *p_Out);
+
+    /**
+     *  Get the fitness of a backtest from its trade metrics, the profit plus the weighted
+     *  metrics of the fitness_* settings. Weights of 0.0 are left out.
+     *
+     *  \param s_Simulator The account after the backtest.
+     *
+     *  \return The fitness, without the -300 for no action.
+     */
+
+    template<class Simulator>
+    inline double getFitness(const Simulator &s_Simulator) const noexcept;
 
     /**********************************************************************************************
      * Data
@@ -334,7 +519,40 @@ private:
     int leverage;
     double exposure;
     double fee;
+    int batch_size; // Rows per activate_batch call, 0 == activate every row
+    int lockstep; // Genomes per thread stepped through the rows together
+    int engine; // Engine for batch_size == 0, 0 == switch per neuron, 1 == bytecode, 2 == bytecode and a native winner report
+    int precision; // Bits of the dataset and network scalars, 64 == double, 32 == float
+    int optimize; // Run feed_forward_network::optimize on every phenotype, 0 == off
+    double prune_weight; // Links with |weight| <= prune_weight are removed by optimize
+    int recurrent; // 1 == recurrent networks fed one candle per step, 0 == feed forward on windows
+    int phenotype_cache; // Built phenotypes kept for unchanged genomes, least recently used evicted, 0 == off
+    int race_segments; // Successive halving over this many segments of the dataset, 1 == off, feed forward only
+    double race_promotion; // Part of the genomes promoted to the next segment
+    int minibatch_windows; // Random windows of the dataset per generation shared by all genomes, 0 == all rows
+    int minibatch_rows; // Rows per window
+    int minibatch_check; // Generations between rank correlation checks against all rows, 0 == never
+    int asset_fitness; // Fitness of a genome on several datasets, 0 == mean, 1 == min
+    int validate; // Score new best genomes on the *-validate.csv of the datasets in the background, 0 == off
+    int market; // Trading rules, 0 == forex lots, 1 == crypto margin, picks ForexEval or CryptoEval
+    double fitness_sharpe; // Added to the profit in percent per unit of Sharpe ratio
+    double fitness_drawdown; // Taken from it per percent of maximum drawdown
+    double fitness_winrate; // Added per percent of winning trades
+    double fitness_exposure; // Added per percent of candles in a position, < 0 to favour waiting
+    int fitness_cache; // Fitness of this many unchanged genomes kept across generations, 0 == off
+    int schedule; // Order genomes are handed to the threads, 0 == storage order, 1 == largest first
+
+    // Not serialized
+    std::string native_cache; // Shared objects of engine 2, empty == the report is not compiled
+
+protected:
 
 };
 
+// Lot based forex contracts
+typedef BacktestEval<ForexMarket> ForexEval;
+
+// Leveraged crypto margin trading with liquidation levels
+typedef BacktestEval<CryptoMarket> CryptoEval;
+
 #endif /* EvalFunctions_hpp */
@@ -16,15 +16,21 @@
 #include <condition_variable>
 #include <chrono>
 #include <csignal>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
 
 // External
 #include <cereal/archives/json.hpp>
 #include <cereal/archives/binary.hpp>
 #include <ncurses.h>
+#include <ErrorLog.hpp>
 
 // Project
 #include "./OHLCVManager.hpp"
 #include "./EvalFunctions.h"
+#include "./ValidationWorker.hpp"
+#include "./WorkerPool.hpp"
 
 
 
@@ -59,28 +65,51 @@ int main(int argc, const char *argv[])
 
     int outputs = 2;
     double fitness_threshold = 2;
-    std::string datapath = home_directory + "/dataset/ForexData/EURUSD/EURUSD15_MetaQuots.csv";
+    std::vector<std::string> v_Datapaths;
     int window_size = 120;
 
-    // Define vars via argv
-    for(int i = 1; i <= argc -1 ; i++)
+    // Define vars via argv: one or more datasets or manifests, then the numbers
+    int i_Arg = 1;
+    for (; i_Arg < argc; i_Arg++)
     {
-        switch(i)
+        char *p_End;
+        std::strtod(argv[i_Arg], &p_End);
+        if (p_End != argv[i_Arg] && *p_End == '\0')
         {
-            case 1: datapath = argv[1];
-                    break;
-            case 2: window_size = std::atoi(argv[2]);
+            break;
+        }
+
+        std::vector<std::string> v_Paths = OHLCVManager::getDatasetPaths(argv[i_Arg]);
+        v_Datapaths.insert(v_Datapaths.end(), v_Paths.begin(), v_Paths.end());
+    }
+    if (v_Datapaths.empty())
+    {
+        v_Datapaths.push_back(home_directory + "/dataset/ForexData/EURUSD/EURUSD15_MetaQuots.csv");
+    }
+
+    for(int i = i_Arg; i <= argc -1 ; i++)
+    {
+        switch(i - i_Arg)
+        {
+            case 0: window_size = std::atoi(argv[i]);
                     break;
-            case 3: fitness_threshold = std::atof(argv[1]);
+            case 1: fitness_threshold = std::atof(argv[i]);
                     break;
-            case 4: outputs = std::atoi(argv[2]);
+            case 2: outputs = std::atoi(argv[i]);
                     break;
         }
     }
 
-    // Define
-    std::vector<std::vector<double>> v_Data;
-    std::vector<std::thread> v_Thread;
+    // Define, one entry per asset
+    std::vector<std::vector<double>> v_Candles(v_Datapaths.size());
+    std::vector<std::vector<float>> v_CandlesF(v_Datapaths.size());
+    std::vector<OHLCVDataset> v_Datasets(v_Datapaths.size());
+    std::vector<WindowView<double>> v_Data;
+    std::vector<WindowView<float>> v_DataF;
+    WindowView<double> s_Data; // The first asset
+    WindowView<float> s_DataF;
+    std::vector<size_t> v_AssetRows;
+    size_t us_CandleSize;
 
     // Timestuff
     std::chrono::high_resolution_clock::time_point s_GenerationStart;
@@ -88,50 +117,198 @@ int main(int argc, const char *argv[])
     std::chrono::high_resolution_clock::time_point s_EvalEnd;
     std::chrono::high_resolution_clock::time_point s_EvolutionStart;
     std::chrono::high_resolution_clock::time_point s_TotalStart = std::chrono::high_resolution_clock::now();
-    unsigned int ui_AdditionalThreadCount;
+    double f64_CandleEvals;
+    ForexEval s_forexEval;
+    CryptoEval s_cryptoEval;
 
+    // Make archive with config for evaluation, both markets read the same settings
+    {
+        std::ifstream fs_evalConfig;
+        fs_evalConfig.open(home_directory + "/config/EvalSettings.json");
+        cereal::JSONInputArchive c_evalConfig(fs_evalConfig);
+        s_forexEval.serialization(c_evalConfig);
+        s_cryptoEval.serialization(c_evalConfig);
+    }
+
+    // Shared objects of the winner with engine 2, kept across runs
+    s_forexEval.setNativeCache(home_directory + "/native");
+    s_cryptoEval.setNativeCache(home_directory + "/native");
+
+    // Trading rules, the settings are the same for both
+    bool b_Crypto = s_forexEval.getMarket() == 1;
+
+    // Recurrent networks keep their state and see one candle per step
+    bool b_Recurrent = s_forexEval.isRecurrent();
+    if (b_Recurrent)
+    {
+        window_size = 0;
+    }
 
     // Load dataset
 #ifdef __APPLE__
     chdir("/Users/Jens/Desktop/CNT/res/APPL_ROOT");
 #endif
-    v_Data = OHLCVManager::getlocalOHLCV(datapath, window_size);
-    unsigned int i_Input = v_Data[0].size(); // = 0
+    // Every candle is stored once, the rows of window_size + 1 candles are views into it,
+    // the close prices are read from the columns of the dataset
+    us_CandleSize = 0;
+    for (size_t i = 0; i < v_Datapaths.size(); ++i)
+    {
+        v_Candles[i] = OHLCVManager::getlocalCandles(v_Datapaths[i], v_Datasets[i]);
+
+        // All assets feed the same networks
+        if (i > 0 && v_Datasets[i].GetCandleSize() != us_CandleSize)
+        {
+            throw std::runtime_error("Candle size of " + v_Datapaths[i] + " differs from " + v_Datapaths[0]);
+        }
+        us_CandleSize = v_Datasets[i].GetCandleSize();
+
+        v_Data.push_back(WindowView<double>::Windows(v_Candles[i], us_CandleSize, window_size,
+                                                     v_Datasets[i].GetClose<double>()));
+        v_AssetRows.push_back(v_Data[i].GetRows());
+    }
+    s_Data = v_Data[0];
+    unsigned int i_Input = s_Data.GetRowSize();
+    size_t us_Rows = s_Data.GetRows();
+    size_t us_AssetRows = std::accumulate(v_AssetRows.begin(), v_AssetRows.end(), static_cast<size_t>(0));
 
 
     // Create thread info
-    TraderPool s_Pool(home_directory, i_Input, outputs);
-    ThreadSync s_ThreadSync;
-    ForexEval s_forexEval;
+    TraderPool s_Pool(home_directory, i_Input, outputs, b_Recurrent);
+
+    // Every genome on every asset, the fitness is the mean or the minimum of the assets
+    s_Pool.SetAssets(v_AssetRows, [&](const std::vector<double> &v_Fitness) {
+        return s_forexEval.getAssetFitness(v_Fitness);
+    });
+
+    // Successive halving, only the best genomes of a segment see the next one.
+    // Racing and mini-batches split the rows of one dataset, several assets are evaluated in full.
+    size_t us_RaceSegments;
+    double f64_RacePromotion;
+    s_forexEval.getRacing(us_RaceSegments, f64_RacePromotion);
+    if (v_Data.size() > 1)
+    {
+        us_RaceSegments = 1;
+    }
+    s_Pool.SetRacing(us_RaceSegments, f64_RacePromotion);
 
-    // Make archive with config for evaluation
+    // Survivors and unmutated clones keep their fitness, the cache key continues a hash of the datasets
+    uint64_t ui_DatasetKey = cann::fnv1a(&window_size, sizeof(window_size));
+    for (auto &it_Path : v_Datapaths)
     {
-        std::ifstream fs_evalConfig;
-        fs_evalConfig.open(home_directory + "/config/EvalSettings.json");
-        cereal::JSONInputArchive c_evalConfig(fs_evalConfig);
-        s_forexEval.serialization(c_evalConfig);
+        ui_DatasetKey = cann::fnv1a(it_Path.data(), it_Path.size(), ui_DatasetKey);
     }
+    s_Pool.SetFitnessCache(s_forexEval.getFitnessCache(), ui_DatasetKey);
+
+    // Built phenotypes of unchanged genomes, shared by the evaluation threads
+    s_Pool.SetPhenotypeCache(s_forexEval.getPhenotypeCache());
+
+    // Largest genomes first, the threads run out of work together
+    s_Pool.SetScheduling(s_forexEval.isLargestFirst());
 
-    // Start all worker threads needed
-    ui_AdditionalThreadCount = std::thread::hardware_concurrency() - 1;
-    for (unsigned int i = 0; i < ui_AdditionalThreadCount; ++i)
+    // Evolve in float, the double candles are kept to validate the winner
+    bool b_Float = s_forexEval.getPrecision() == 32;
+    if (b_Float)
     {
-        v_Thread.push_back(
-                std::thread(ForexEval::evaluate, s_forexEval, &s_Pool, &s_ThreadSync, std::ref(v_Data), false));
+        for (size_t i = 0; i < v_Datasets.size(); ++i)
+        {
+            v_Datasets[i].CreateFloat();
+            v_CandlesF[i] = v_Datasets[i].GetCandles<float>();
+            v_DataF.push_back(WindowView<float>::Windows(v_CandlesF[i], us_CandleSize, window_size,
+                                                         v_Datasets[i].GetClose<float>()));
+        }
+        s_DataF = v_DataF[0];
     }
 
-    // TODO: Condition variable, remove busy loop and counter!
-    while (s_ThreadSync.GetWaiting() < ui_AdditionalThreadCount);
+    // Mini-batch, the species champions are scored on all rows before they are ranked and saved
+    size_t us_MiniBatchWindows;
+    size_t us_MiniBatchRows;
+    size_t us_MiniBatchCheck;
+    double f64_RankCorrelation = 1.0;
+    s_forexEval.getMiniBatch(us_MiniBatchWindows, us_MiniBatchRows, us_MiniBatchCheck);
+    if (v_Data.size() > 1)
+    {
+        us_MiniBatchWindows = 0;
+    }
+    if (us_MiniBatchWindows > 0)
+    {
+        s_Pool.SetChampionScore([&](cneat::genome &s_Genome) {
+            if (b_Crypto)
+            {
+                return b_Float ? CryptoEval::score(s_cryptoEval, s_Genome, s_DataF, outputs)
+                               : CryptoEval::score(s_cryptoEval, s_Genome, s_Data, outputs);
+            }
+
+            return b_Float ? ForexEval::score(s_forexEval, s_Genome, s_DataF, outputs)
+                           : ForexEval::score(s_forexEval, s_Genome, s_Data, outputs);
+        });
+    }
+
+    // Walk-forward validation, every new best genome is scored on the *-validate.csv of the datasets
+    // in the background, in double and without touching the evaluation threads
+    std::unique_ptr<ValidationWorker> p_Validation;
+    std::vector<std::string> v_ValidatePaths;
+    if (s_forexEval.isValidating())
+    {
+        for (auto &it_Path : v_Datapaths)
+        {
+            std::string s_ValidatePath = OHLCVManager::getValidationPath(it_Path);
+            if (!s_ValidatePath.empty())
+            {
+                v_ValidatePaths.push_back(s_ValidatePath);
+            }
+        }
+    }
+    if (!v_ValidatePaths.empty())
+    {
+        p_Validation.reset(new ValidationWorker(v_ValidatePaths, window_size,
+                                                [=](cneat::genome &s_Genome, const WindowView<double> &s_View) {
+            return b_Crypto ? CryptoEval::score(s_cryptoEval, s_Genome, s_View, outputs)
+                            : ForexEval::score(s_forexEval, s_Genome, s_View, outputs);
+        }, [=](const std::vector<double> &v_Fitness) {
+            return s_forexEval.getAssetFitness(v_Fitness);
+        }, s_Pool.GetSavePath() + "/Validation.csv"));
+
+        ValidationWorker *p_Worker = p_Validation.get();
+        s_Pool.SetNewBest([p_Worker](const cneat::genome &s_Genome, unsigned int ui_Generation) {
+            p_Worker->Submit(s_Genome, ui_Generation);
+        });
+    }
+
+    // Start all worker threads needed, they sleep until there are tasks
+    WorkerPool s_Workers(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+    s_Pool.SetWorkers(&s_Workers);
+
+    // Chunks of race entries shrink with the work left, never below a lockstep group
+    s_Pool.SetClaiming(s_Workers.GetThreadCount() + 1, s_forexEval.getLockstep());
 
     /**
      * Becuase i am a fancy guy i need curses
      */
     initscr();
-    WINDOW * win = newwin(20, 80, 0, 0);
+    WINDOW * win = newwin(24, 80, 0, 0);
     mvwaddstr(win, 18, 1, "Evaluation in progress... Press CTRL-C to quit.");
     std::string cursesUpdate;
 
 
+    // Evaluate the pool with all threads, once per rung of the race
+    std::function<void()> f_EvaluateRung = [&]() {
+        if (b_Crypto && b_Float)
+        {
+            CryptoEval::evaluate(s_cryptoEval, &s_Pool, v_DataF);
+        } else if (b_Crypto) {
+            CryptoEval::evaluate(s_cryptoEval, &s_Pool, v_Data);
+        } else if (b_Float) {
+            ForexEval::evaluate(s_forexEval, &s_Pool, v_DataF);
+        } else {
+            ForexEval::evaluate(s_forexEval, &s_Pool, v_Data);
+        }
+    };
+    auto evaluatePool = [&]() {
+        do {
+            s_Workers.Run(f_EvaluateRung);
+        } while (s_Pool.NextRung(us_Rows));
+    };
+
     // Evaluate until the required fitness was reached
     while (true) {
 
@@ -142,16 +319,74 @@ int main(int argc, const char *argv[])
 
         // Reset
         s_GenerationStart = std::chrono::high_resolution_clock::now();
-        s_Pool.Reset();
 
-        // Evaluate using the main thread
+        // Evaluate using the main thread, on all rows or on the windows of this generation.
+        // The fitness on windows changes every generation, it bypasses the fitness cache.
         s_EvalStart = std::chrono::high_resolution_clock::now();
-        ForexEval::evaluate(s_forexEval, &s_Pool, &s_ThreadSync, std::ref(v_Data), true);
+        if (us_MiniBatchWindows > 0)
+        {
+            s_Pool.Reset(false);
+            s_Pool.DrawWindows(us_Rows, us_MiniBatchWindows, us_MiniBatchRows);
+            evaluatePool();
+            f64_CandleEvals = static_cast<double>(s_Pool.GetPopulationSize()) * us_MiniBatchWindows *
+                              std::min(us_MiniBatchRows, us_Rows);
+
+            // Check how well the windows rank the genomes, the fitness on all rows is kept for this generation
+            if (us_MiniBatchCheck > 0 && s_Pool.GetGeneration() % us_MiniBatchCheck == 0)
+            {
+                std::vector<double> v_MiniBatchFitness = s_Pool.GetFitness();
+
+                s_Pool.ClearWindows();
+                s_Pool.Reset();
+                evaluatePool();
+                f64_CandleEvals += static_cast<double>(s_Pool.GetPopulationSize() -
+                                                       s_Pool.GetFitnessCacheReport().hits) * us_Rows;
+
+                f64_RankCorrelation = TraderPool::GetRankCorrelation(v_MiniBatchFitness, s_Pool.GetFitness());
+                ErrorLog::LogError("Generation " + std::to_string(s_Pool.GetGeneration()) +
+                                   ": rank correlation of mini-batch and full fitness " +
+                                   std::to_string(f64_RankCorrelation),
+                                   s_Pool.GetSavePath() + "/MiniBatchLog.dat");
+            }
+        } else {
+            s_Pool.Reset();
+            evaluatePool();
+            f64_CandleEvals = static_cast<double>(s_Pool.GetPopulationSize() - s_Pool.GetFitnessCacheReport().hits) *
+                              us_AssetRows - s_Pool.GetSkippedRows();
+        }
         s_EvalEnd = std::chrono::high_resolution_clock::now();
 
-        // Wait for the threads if finished first
-        // TODO: Condition variable, remove busy loop and counter!
-        while (s_ThreadSync.GetWaiting() < ui_AdditionalThreadCount);
+        ErrorLog::LogError("Generation " + std::to_string(s_Pool.GetGeneration()) + ": tail latency " +
+                           std::to_string(s_Pool.GetTailLatency()) + " of " +
+                           std::to_string(std::chrono::duration_cast<std::chrono::duration<double>>(
+                                   s_EvalEnd - s_EvalStart).count()) + " seconds evaluation, wake latency " +
+                           std::to_string(s_Workers.GetWakeReport().f64_Mean) + " mean " +
+                           std::to_string(s_Workers.GetWakeReport().f64_Max) + " max, " +
+                           std::to_string(s_Pool.GetClaimReport().us_Chunks) + " chunks " +
+                           std::to_string(s_Pool.GetClaimReport().us_Groups) + " claims " +
+                           std::to_string(s_Pool.GetClaimReport().us_Contended) + " contended, " +
+                           std::to_string(s_Workers.GetTaskReport().us_Tasks) + " tasks " +
+                           std::to_string(s_Workers.GetTaskReport().us_Steals) + " steals",
+                           s_Pool.GetSavePath() + "/ScheduleLog.dat");
+        s_Workers.ResetWakeReport();
+
+        cann::cache_report s_FitnessCache = s_Pool.GetFitnessCacheReport();
+        if (s_FitnessCache.hits + s_FitnessCache.misses > 0)
+        {
+            ErrorLog::LogError("Generation " + std::to_string(s_Pool.GetGeneration()) + ": fitness cache " +
+                               std::to_string(s_FitnessCache.hits) + " hits, " +
+                               std::to_string(s_FitnessCache.misses) + " evaluated, " +
+                               std::to_string(s_FitnessCache.evictions) + " evicted",
+                               s_Pool.GetSavePath() + "/FitnessCacheLog.dat");
+        }
+
+        if (us_RaceSegments > 1)
+        {
+            ErrorLog::LogError("Generation " + std::to_string(s_Pool.GetGeneration()) + ": " +
+                               std::to_string(static_cast<size_t>(f64_CandleEvals)) + " candle-evals, " +
+                               std::to_string(s_Pool.GetSkippedRows()) + " skipped by racing",
+                               s_Pool.GetSavePath() + "/RacingLog.dat");
+        }
 
         // Check resulting fitness
         if (s_Pool.GetMaxFitness() >= fitness_threshold) {
@@ -213,6 +448,67 @@ int main(int argc, const char *argv[])
                 std::chrono::high_resolution_clock::now() - s_EvolutionStart).count());
         mvwaddstr(win, 14, 35, cursesUpdate.c_str());
 
+        cursesUpdate = "Candle-evals/sec:";
+        mvwaddstr(win, 16, 1, cursesUpdate.c_str());
+        cursesUpdate = std::to_string(f64_CandleEvals /
+                std::chrono::duration_cast<std::chrono::duration<double>>(s_EvalEnd - s_EvalStart).count());
+        mvwaddstr(win, 16, 35, cursesUpdate.c_str());
+
+        cann::optimization_report s_Report = s_Pool.GetOptimizationReport();
+        cursesUpdate = "Optimized nodes / links:";
+        mvwaddstr(win, 17, 1, cursesUpdate.c_str());
+        cursesUpdate = std::to_string(s_Report.nodes_before) + " -> " + std::to_string(s_Report.nodes_after) + " / " +
+                       std::to_string(s_Report.links_before) + " -> " + std::to_string(s_Report.links_after);
+        mvwaddstr(win, 17, 35, cursesUpdate.c_str());
+
+        cann::cache_report s_Cache = s_Pool.GetCacheReport();
+        cursesUpdate = "Phenotype cache hits / misses:";
+        mvwaddstr(win, 18, 1, cursesUpdate.c_str());
+        cursesUpdate = std::to_string(s_Cache.hits) + " / " + std::to_string(s_Cache.misses) + " (" +
+                       std::to_string(s_Cache.evictions) + " evicted)";
+        mvwaddstr(win, 18, 35, cursesUpdate.c_str());
+
+        cursesUpdate = "Racing skipped candle-evals:";
+        mvwaddstr(win, 19, 1, cursesUpdate.c_str());
+        cursesUpdate = std::to_string(s_Pool.GetSkippedRows());
+        mvwaddstr(win, 19, 35, cursesUpdate.c_str());
+
+        cursesUpdate = "Mini-batch rank correlation:";
+        mvwaddstr(win, 20, 1, cursesUpdate.c_str());
+        cursesUpdate = us_MiniBatchWindows > 0 ? std::to_string(f64_RankCorrelation) : "off";
+        mvwaddstr(win, 20, 35, cursesUpdate.c_str());
+
+        ValidationResult s_Validation;
+        cursesUpdate = "Walk-forward train / validate:";
+        mvwaddstr(win, 21, 1, cursesUpdate.c_str());
+        if (!p_Validation)
+        {
+            cursesUpdate = "off";
+        } else if (p_Validation->GetLastResult(s_Validation)) {
+            cursesUpdate = std::to_string(s_Validation.f64_Train) + " / " + std::to_string(s_Validation.f64_Validate) +
+                           " (gen " + std::to_string(s_Validation.ui_Generation) + ")";
+        } else {
+            cursesUpdate = "pending";
+        }
+        mvwaddstr(win, 21, 35, cursesUpdate.c_str());
+
+        cursesUpdate = "Fitness cache hits / evaluated:";
+        mvwaddstr(win, 22, 1, cursesUpdate.c_str());
+        if (s_FitnessCache.hits + s_FitnessCache.misses > 0)
+        {
+            cursesUpdate = std::to_string(s_FitnessCache.hits) + " / " + std::to_string(s_FitnessCache.misses) + " (" +
+                           std::to_string(100 * s_FitnessCache.hits / (s_FitnessCache.hits + s_FitnessCache.misses)) +
+                           "%)";
+        } else {
+            cursesUpdate = "off";
+        }
+        mvwaddstr(win, 22, 35, cursesUpdate.c_str());
+
+        cursesUpdate = "Tail latency(sec):";
+        mvwaddstr(win, 23, 1, cursesUpdate.c_str());
+        cursesUpdate = std::to_string(s_Pool.GetTailLatency());
+        mvwaddstr(win, 23, 35, cursesUpdate.c_str());
+
         cursesUpdate = "Evaltime(sec):";
         mvwaddstr(win, 15, 1, cursesUpdate.c_str());
         cursesUpdate = std::to_string(std::chrono::duration_cast<std::chrono::duration<double>>(
@@ -238,18 +534,22 @@ int main(int argc, const char *argv[])
     endwin();
 
     // Stop and join threads.
-    s_ThreadSync.SetKillThreads(true);
-    s_ThreadSync.NotifyWaiting();
+    s_Pool.SetWorkers(NULL);
+    s_Workers.Finish();
 
-    for (size_t i = 0; i < v_Thread.size(); ++i)
+    // Finish the last validation
+    if (p_Validation)
     {
-        v_Thread[i].join();
+        p_Validation->Finish();
     }
 
     // Export winner to file
     double f64_BestFitness = -999.f;
     cneat::genome *p_CurrentGenome;
     cneat::genome *p_WinnerGenome = NULL;
+    TradeReport s_WinnerReport = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0};
+    size_t us_Mismatches = 0; // Rows where the float winner acts differently in double
+    bool b_CheckedFloat = false;
 
     s_Pool.Reset();
     while ((p_CurrentGenome = s_Pool.GetNextGenome()) != NULL)
@@ -263,16 +563,34 @@ int main(int argc, const char *argv[])
 
     if (p_WinnerGenome != NULL)
     {
-        cann::feed_forward_network s_NeuralNet; // Change here for recurrent
-        s_NeuralNet.from_genome(*p_WinnerGenome);
+        // Write winner ANN to file, binary and human readable
+        auto writeNetwork = [&](auto &s_NeuralNet) {
+            s_NeuralNet.from_genome(*p_WinnerGenome);
 
-        // Write winner ANN to file
-        {
-            std::ofstream ofs_ann;
-            ofs_ann.open(s_Pool.GetSavePath() + "/Winner.cann", std::ios::binary);
+            {
+                std::ofstream ofs_ann;
+                ofs_ann.open(s_Pool.GetSavePath() + "/Winner.cann", std::ios::binary);
+
+                cereal::BinaryOutputArchive outArchive(ofs_ann);
+                s_NeuralNet.serialization(outArchive);
+            }
+
+            {
+                std::ofstream ofs_ann;
+                ofs_ann.open(s_Pool.GetSavePath() + "/Winner_cann.json");
 
-            cereal::BinaryOutputArchive outArchive(ofs_ann);
-            s_NeuralNet.serialization(outArchive);
+                cereal::JSONOutputArchive outArchive(ofs_ann);
+                s_NeuralNet.serialization(outArchive);
+            }
+        };
+
+        if (b_Recurrent)
+        {
+            cann::recurrent_network s_NeuralNet;
+            writeNetwork(s_NeuralNet);
+        } else {
+            cann::feed_forward_network s_NeuralNet;
+            writeNetwork(s_NeuralNet);
         }
 
         // Write Winner Genome to File
@@ -287,17 +605,8 @@ int main(int argc, const char *argv[])
 
 
         /**
-         * Write genome and ann to a human readable json file
+         * Write genome to a human readable json file
          */
-        {
-            std::ofstream ofs_ann;
-            ofs_ann.open(s_Pool.GetSavePath() + "/Winner_cann.json");
-
-            cereal::JSONOutputArchive outArchive(ofs_ann);
-            s_NeuralNet.serialization(outArchive);
-        }
-
-
         {
             std::ofstream ofs_genome;
             ofs_genome.open(s_Pool.GetSavePath() + "/Winner_genome.json");
@@ -307,7 +616,29 @@ int main(int argc, const char *argv[])
 
         }
 
+        // Write the trades and the equity curve of the winner on the first dataset
+        {
+            std::vector<TradeLogEntry> v_TradeLog;
+            s_WinnerReport = b_Crypto ? CryptoEval::report(s_cryptoEval, *p_WinnerGenome, s_Data, outputs, v_TradeLog)
+                                      : ForexEval::report(s_forexEval, *p_WinnerGenome, s_Data, outputs, v_TradeLog);
+
+            std::ofstream ofs_trades;
+            ofs_trades.open(s_Pool.GetSavePath() + "/Winner_trades.csv");
+
+            ofs_trades << "row,close,action,quantity,equity" << std::endl;
+            for (size_t i = 0; i < v_TradeLog.size(); i++)
+            {
+                ofs_trades << i << "," << v_TradeLog[i].f64_Close << "," << v_TradeLog[i].i_Action << ","
+                           << v_TradeLog[i].f64_Quantity << "," << v_TradeLog[i].f64_Equity << std::endl;
+            }
+        }
 
+        // Validate the float winner in double, the actions do not depend on the market
+        if (b_Float && !b_Recurrent)
+        {
+            us_Mismatches = ForexEval::countActionMismatches(s_forexEval, *p_WinnerGenome, s_Data, s_DataF, outputs);
+            b_CheckedFloat = true;
+        }
     }
 
     // Result
@@ -315,6 +646,23 @@ int main(int argc, const char *argv[])
               << fitness_threshold << std::endl;
     std::cout << "Size: N: " << p_WinnerGenome->node_genes.size() << " C: " << p_WinnerGenome->connection_genes.size()
               << std::endl;
+    std::cout << "Profit: " << s_WinnerReport.f64_Profit << "% Sharpe: " << s_WinnerReport.f64_Sharpe
+              << " Max drawdown: " << 100.0 * s_WinnerReport.f64_MaxDrawdown << "% Trades: " << s_WinnerReport.i_Trades
+              << " Win rate: " << 100.0 * s_WinnerReport.f64_WinRate << "% Exposure: "
+              << 100.0 * s_WinnerReport.f64_Exposure << "%" << std::endl;
+
+    if (b_CheckedFloat)
+    {
+        std::cout << "Actions float / double: " << us_Mismatches << " of " << us_Rows << " rows differ ("
+                  << 100.0 * us_Mismatches / us_Rows << "%)" << std::endl;
+    }
+    ValidationResult s_Validation;
+    if (p_Validation && p_Validation->GetLastResult(s_Validation))
+    {
+        std::cout << "Walk-forward train / validate: " << s_Validation.f64_Train << " / " << s_Validation.f64_Validate
+                  << " (generation " << s_Validation.ui_Generation << ", " << p_Validation->GetDropped()
+                  << " stale jobs dropped)" << std::endl;
+    }
     std::cout << "Fitness reached in " << std::chrono::duration_cast<std::chrono::duration<double>>(
             std::chrono::high_resolution_clock::now() - s_TotalStart).count() << " seconds." << std::endl;
     return EXIT_SUCCESS;
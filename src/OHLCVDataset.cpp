@@ -0,0 +1,384 @@
+//
+//  OHLCVDataset.cpp
+//  CNT
+//
+
+// C / C++
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+
+// External
+#include <convertcsv.hpp>
+
+// Project
+#include "./OHLCVDataset.hpp"
+
+
+namespace {
+
+    /**
+     *  Parse a field which is a number and nothing else.
+     */
+
+    bool parseNumber(const std::string &s_Field, double &f64_Value) {
+        if (s_Field.empty()) {
+            return false;
+        }
+
+        char *p_End;
+        f64_Value = std::strtod(s_Field.c_str(), &p_End);
+
+        return p_End == s_Field.c_str() + s_Field.size();
+    }
+
+    /**
+     *  Split s_Field into its groups of digits.
+     *
+     *  \return False if anything but digits and c_Seperators is found.
+     */
+
+    bool digitGroups(const std::string &s_Field, const char *c_Seperators, std::vector<std::string> &v_Groups) {
+        v_Groups.assign(1, std::string());
+
+        for (char c : s_Field) {
+            if (std::isdigit(static_cast<unsigned char>(c))) {
+                v_Groups.back() += c;
+            } else if (std::strchr(c_Seperators, c) != nullptr && !v_Groups.back().empty()) {
+                v_Groups.push_back(std::string());
+            } else {
+                return false;
+            }
+        }
+
+        return !v_Groups.back().empty();
+    }
+
+    /**
+     *  Days since 1970-01-01 of a date in the proleptic Gregorian calendar.
+     */
+
+    int64_t daysFromCivil(int64_t i_Year, int64_t i_Month, int64_t i_Day) {
+        i_Year -= i_Month <= 2;
+        int64_t i_Era = (i_Year >= 0 ? i_Year : i_Year - 399) / 400;
+        int64_t i_YearOfEra = i_Year - i_Era * 400;
+        int64_t i_DayOfYear = (153 * (i_Month + (i_Month > 2 ? -3 : 9)) + 2) / 5 + i_Day - 1;
+        int64_t i_DayOfEra = i_YearOfEra * 365 + i_YearOfEra / 4 - i_YearOfEra / 100 + i_DayOfYear;
+
+        return i_Era * 146097 + i_DayOfEra - 719468;
+    }
+
+    /**
+     *  Parse HH:MM[:SS] or HHMM to seconds.
+     */
+
+    bool parseTime(const std::string &s_Field, int64_t &i_Seconds) {
+        std::vector<std::string> v_Groups;
+        int64_t i_Hour;
+        int64_t i_Minute;
+        int64_t i_Second = 0;
+
+        if (!digitGroups(s_Field, ":", v_Groups)) {
+            return false;
+        }
+
+        if (v_Groups.size() == 1 && v_Groups[0].size() >= 3 && v_Groups[0].size() <= 4) {
+            i_Hour = std::atoi(v_Groups[0].substr(0, v_Groups[0].size() - 2).c_str());
+            i_Minute = std::atoi(v_Groups[0].substr(v_Groups[0].size() - 2).c_str());
+        } else if (v_Groups.size() == 2 || v_Groups.size() == 3) {
+            i_Hour = std::atoi(v_Groups[0].c_str());
+            i_Minute = std::atoi(v_Groups[1].c_str());
+            if (v_Groups.size() == 3) {
+                i_Second = std::atoi(v_Groups[2].c_str());
+            }
+        } else {
+            return false;
+        }
+
+        if (i_Hour > 23 || i_Minute > 59 || i_Second > 60) {
+            return false;
+        }
+
+        i_Seconds = i_Hour * 3600 + i_Minute * 60 + i_Second;
+        return true;
+    }
+
+    /**
+     *  Parse YYYY-MM-DD, YYYY.MM.DD, DD.MM.YYYY or DDMMYYYY, optionally followed
+     *  by a time after a space or a T, to seconds since 1970-01-01 UTC.
+     */
+
+    bool parseDate(const std::string &s_Field, int64_t &i_Seconds) {
+        std::vector<std::string> v_Groups;
+        std::string s_Date = s_Field;
+        int64_t i_Time = 0;
+        int64_t i_Year;
+        int64_t i_Month;
+        int64_t i_Day;
+
+        size_t us_Split = s_Field.find_first_of(" T");
+        if (us_Split != std::string::npos) {
+            s_Date = s_Field.substr(0, us_Split);
+            if (!parseTime(s_Field.substr(us_Split + 1), i_Time)) {
+                return false;
+            }
+        }
+
+        if (!digitGroups(s_Date, "-./", v_Groups)) {
+            return false;
+        }
+
+        if (v_Groups.size() == 3) {
+            if (v_Groups[0].size() == 4) {
+                i_Year = std::atoi(v_Groups[0].c_str());
+                i_Day = std::atoi(v_Groups[2].c_str());
+            } else if (v_Groups[2].size() == 4) {
+                i_Year = std::atoi(v_Groups[2].c_str());
+                i_Day = std::atoi(v_Groups[0].c_str());
+            } else {
+                return false;
+            }
+            i_Month = std::atoi(v_Groups[1].c_str());
+        } else if (v_Groups.size() == 1 && (v_Groups[0].size() == 7 || v_Groups[0].size() == 8)) {
+            // DDMMYYYY, the day may have a single digit
+            const std::string &s_Digits = v_Groups[0];
+            i_Day = std::atoi(s_Digits.substr(0, s_Digits.size() - 6).c_str());
+            i_Month = std::atoi(s_Digits.substr(s_Digits.size() - 6, 2).c_str());
+            i_Year = std::atoi(s_Digits.substr(s_Digits.size() - 4).c_str());
+        } else {
+            return false;
+        }
+
+        if (i_Month < 1 || i_Month > 12 || i_Day < 1 || i_Day > 31) {
+            return false;
+        }
+
+        i_Seconds = daysFromCivil(i_Year, i_Month, i_Day) * 86400 + i_Time;
+        return true;
+    }
+
+    /**
+     *  Lower case copy.
+     */
+
+    std::string lower(const std::string &s_Field) {
+        std::string s_Lower = s_Field;
+        for (char &c : s_Lower) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+
+        return s_Lower;
+    }
+
+} // End of anonymous namespace
+
+
+/**************************************************************************************
+ * Constructor / Destructor
+ * ------------------------
+ * Called on new and delete.
+ **************************************************************************************/
+
+OHLCVDataset::OHLCVDataset() noexcept : b_Volume(false), b_Timestamp(false) {}
+
+OHLCVDataset::~OHLCVDataset() noexcept {}
+
+/**************************************************************************************
+ * Load
+ * ----
+ * Read a CSV file into the columns.
+ **************************************************************************************/
+
+void OHLCVDataset::Load(const std::string &s_FilePath) {
+    // Field index of every column, -1 == not in the file
+    int i_Fields[5] = {-1, -1, -1, -1, -1};
+    int i_Date = -1;
+    int i_Time = -1;
+    bool b_Layout = false;
+    size_t us_Line = 0;
+    double f64_Value;
+    int64_t i_Seconds;
+    int64_t i_Clock;
+
+    for (auto &it_Column : v_Columns) {
+        it_Column.clear();
+    }
+    for (auto &it_Column : v_ColumnsF) {
+        it_Column.clear();
+    }
+    v_Timestamp.clear();
+
+    ConvertCSV::ForEachRecord(s_FilePath, [&](const std::vector<std::string> &v_Fields) -> bool {
+        ++us_Line;
+
+        /*****************************************
+         * Layout from the first record
+         *****************************************/
+
+        if (!b_Layout) {
+            b_Layout = true;
+
+            // A header names the columns
+            bool b_Header = false;
+            for (auto &it_Field : v_Fields) {
+                if (!parseNumber(it_Field, f64_Value) && !parseDate(it_Field, i_Seconds) &&
+                    !parseTime(it_Field, i_Seconds)) {
+                    b_Header = true;
+                }
+            }
+
+            if (b_Header) {
+                for (size_t us_Field = 0; us_Field < v_Fields.size(); us_Field++) {
+                    std::string s_Name = lower(v_Fields[us_Field]);
+                    int i_Field = static_cast<int>(us_Field);
+
+                    if (s_Name == "open") {
+                        i_Fields[OPEN] = i_Field;
+                    } else if (s_Name == "high") {
+                        i_Fields[HIGH] = i_Field;
+                    } else if (s_Name == "low") {
+                        i_Fields[LOW] = i_Field;
+                    } else if (s_Name == "close") {
+                        i_Fields[CLOSE] = i_Field;
+                    } else if (s_Name == "volume") {
+                        i_Fields[VOLUME] = i_Field;
+                    } else if (s_Name == "date" || s_Name == "time" || s_Name == "timestamp" || s_Name == "datetime") {
+                        // A separate time column follows the date
+                        if (i_Date < 0) {
+                            i_Date = i_Field;
+                        } else {
+                            i_Time = i_Field;
+                        }
+                    }
+                }
+
+                if (i_Fields[OPEN] < 0 || i_Fields[HIGH] < 0 || i_Fields[LOW] < 0 || i_Fields[CLOSE] < 0) {
+                    throw std::runtime_error("No open, high, low and close columns in " + s_FilePath);
+                }
+
+                return true;
+            }
+
+            // Leading date and time, then open, high, low, close and volume
+            int i_Field = 0;
+            int i_Count = static_cast<int>(v_Fields.size());
+            if (i_Count > 0 && !parseNumber(v_Fields[0], f64_Value) && parseDate(v_Fields[0], i_Seconds)) {
+                i_Date = i_Field++;
+                if (i_Field < i_Count && !parseNumber(v_Fields[i_Field], f64_Value) &&
+                    parseTime(v_Fields[i_Field], i_Seconds)) {
+                    i_Time = i_Field++;
+                }
+            }
+
+            if (i_Count - i_Field < 4) {
+                throw std::runtime_error("Less than 4 values per candle in " + s_FilePath);
+            }
+
+            for (int i_Column = OPEN; i_Column <= VOLUME && i_Field < i_Count; i_Column++) {
+                i_Fields[i_Column] = i_Field++;
+            }
+        }
+
+        /*****************************************
+         * Candle
+         *****************************************/
+
+        for (int i_Column = OPEN; i_Column <= VOLUME; i_Column++) {
+            if (i_Fields[i_Column] < 0) {
+                continue;
+            }
+
+            if (static_cast<size_t>(i_Fields[i_Column]) >= v_Fields.size() ||
+                !parseNumber(v_Fields[i_Fields[i_Column]], f64_Value)) {
+                throw std::runtime_error("Invalid value in line " + std::to_string(us_Line) + " of " + s_FilePath);
+            }
+
+            v_Columns[i_Column].push_back(f64_Value);
+        }
+
+        if (i_Date >= 0) {
+            i_Clock = 0;
+            if (static_cast<size_t>(i_Date) >= v_Fields.size() || !parseDate(v_Fields[i_Date], i_Seconds) ||
+                (i_Time >= 0 && (static_cast<size_t>(i_Time) >= v_Fields.size() ||
+                                 !parseTime(v_Fields[i_Time], i_Clock)))) {
+                throw std::runtime_error("Invalid date in line " + std::to_string(us_Line) + " of " + s_FilePath);
+            }
+
+            v_Timestamp.push_back(i_Seconds + i_Clock);
+        }
+
+        return true;
+    });
+
+    b_Volume = i_Fields[VOLUME] >= 0;
+    b_Timestamp = i_Date >= 0;
+    if (!b_Timestamp) {
+        v_Timestamp.assign(v_Columns[CLOSE].size(), 0);
+    }
+}
+
+void OHLCVDataset::CreateFloat() {
+    for (int i_Column = OPEN; i_Column <= VOLUME; i_Column++) {
+        v_ColumnsF[i_Column].assign(v_Columns[i_Column].begin(), v_Columns[i_Column].end());
+    }
+}
+
+/**************************************************************************************
+ * Getters
+ * -------
+ * OHLCVDataset getters.
+ **************************************************************************************/
+
+size_t OHLCVDataset::GetSize() const noexcept {
+    return v_Columns[CLOSE].size();
+}
+
+size_t OHLCVDataset::GetCandleSize() const noexcept {
+    return b_Volume ? 5 : 4;
+}
+
+bool OHLCVDataset::HasVolume() const noexcept {
+    return b_Volume;
+}
+
+bool OHLCVDataset::HasTimestamp() const noexcept {
+    return b_Timestamp;
+}
+
+template<>
+const double *OHLCVDataset::GetColumn<double>(Field e_Field) const noexcept {
+    return v_Columns[e_Field].data();
+}
+
+template<>
+const float *OHLCVDataset::GetColumn<float>(Field e_Field) const noexcept {
+    return v_ColumnsF[e_Field].data();
+}
+
+const int64_t *OHLCVDataset::GetTimestamp() const noexcept {
+    return v_Timestamp.data();
+}
+
+template<typename T>
+std::vector<T> OHLCVDataset::GetCandles() const {
+    size_t us_Size = GetSize();
+    size_t us_CandleSize = GetCandleSize();
+    std::vector<T> v_Candles(us_Size * us_CandleSize);
+
+    // Transpose, the newest candle goes first
+    for (size_t us_Column = 0; us_Column < us_CandleSize; us_Column++) {
+        const double *p_Column = v_Columns[us_Column].data();
+        T *p_Candles = v_Candles.data() + us_Column;
+
+        for (size_t i = 0; i < us_Size; i++) {
+            p_Candles[(us_Size - 1 - i) * us_CandleSize] = static_cast<T>(p_Column[i]);
+        }
+    }
+
+    return v_Candles;
+}
+
+// Scalar types of the dataset
+template std::vector<double> OHLCVDataset::GetCandles<double>() const;
+template std::vector<float> OHLCVDataset::GetCandles<float>() const;
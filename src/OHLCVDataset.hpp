@@ -0,0 +1,223 @@
+//
+//  OHLCVDataset.hpp
+//  CNT
+//
+
+#ifndef OHLCVDataset_hpp
+#define OHLCVDataset_hpp
+
+// C / C++
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// External
+
+// Project
+
+
+/**
+ *  Allocator for 64 byte aligned arrays, a cache line and an AVX-512 register.
+ */
+
+template<typename T, size_t us_Alignment = 64>
+class AlignedAllocator {
+public:
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind {
+        typedef AlignedAllocator<U, us_Alignment> other;
+    };
+
+    AlignedAllocator() noexcept {}
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, us_Alignment> &) noexcept {}
+
+    T *allocate(size_t us_Count) {
+        void *p_Memory = nullptr;
+
+        if (us_Count > 0 && posix_memalign(&p_Memory, us_Alignment, us_Count * sizeof(T)) != 0) {
+            throw std::bad_alloc();
+        }
+
+        return static_cast<T *>(p_Memory);
+    }
+
+    void deallocate(T *p_Memory, size_t) noexcept {
+        free(p_Memory);
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, us_Alignment> &) const noexcept {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, us_Alignment> &) const noexcept {
+        return false;
+    }
+};
+
+
+class OHLCVDataset {
+public:
+
+    /**************************************************************************************
+     * Types
+     **************************************************************************************/
+
+    template<typename T>
+    using Column = std::vector<T, AlignedAllocator<T>>;
+
+    // Price and volume columns, in the order of a candle
+    enum Field {
+        OPEN = 0,
+        HIGH = 1,
+        LOW = 2,
+        CLOSE = 3,
+        VOLUME = 4
+    };
+
+    /**************************************************************************************
+     * Constructor / Destructor
+     **************************************************************************************/
+
+    /**
+     *  Default constructor, an empty dataset.
+     */
+
+    OHLCVDataset() noexcept;
+
+    /**
+     *  Default destructor.
+     */
+
+    ~OHLCVDataset() noexcept;
+
+    /**************************************************************************************
+     * Load
+     **************************************************************************************/
+
+    /**
+     *  Load a CSV file, oldest candle first.
+     *
+     *  With a header line the columns are found by name (time / date, open, high, low, close,
+     *  volume, others are ignored). Without one, leading date and time fields are the timestamp
+     *  and the numbers that follow are open, high, low, close and optionally volume.
+     *  Dates are YYYY-MM-DD, YYYY.MM.DD or DDMMYYYY, times HH:MM[:SS] or HHMM, in UTC.
+     *
+     *  \param s_FilePath The full path to the file.
+     */
+
+    void Load(const std::string &s_FilePath);
+
+    /**
+     *  Create the float32 copy of the price and volume columns.
+     */
+
+    void CreateFloat();
+
+    /**************************************************************************************
+     * Getters
+     **************************************************************************************/
+
+    /**
+     *  Get the number of candles.
+     *
+     *  \return The candles of the dataset.
+     */
+
+    size_t GetSize() const noexcept;
+
+    /**
+     *  Get the values per candle fed to a network, open to close and volume if present.
+     *
+     *  \return 4 or 5.
+     */
+
+    size_t GetCandleSize() const noexcept;
+
+    /**
+     *  Check if the file had a volume column.
+     *
+     *  \return True if volume was loaded.
+     */
+
+    bool HasVolume() const noexcept;
+
+    /**
+     *  Check if the file had dates.
+     *
+     *  \return True if timestamps were loaded.
+     */
+
+    bool HasTimestamp() const noexcept;
+
+    /**
+     *  Get a price or volume column, 64 byte aligned.
+     *  The float32 columns exist after CreateFloat().
+     *
+     *  \param e_Field The column.
+     *
+     *  \return GetSize() values, oldest first.
+     */
+
+    template<typename T>
+    const T *GetColumn(Field e_Field) const noexcept;
+
+    /**
+     *  Get the close prices, see GetColumn().
+     *
+     *  \return GetSize() values, oldest first.
+     */
+
+    template<typename T>
+    const T *GetClose() const noexcept {
+        return GetColumn<T>(CLOSE);
+    }
+
+    /**
+     *  Get the timestamps.
+     *
+     *  \return GetSize() seconds since 1970-01-01 UTC, oldest first. 0 if the file had no dates.
+     */
+
+    const int64_t *GetTimestamp() const noexcept;
+
+    /**
+     *  Get the candles back to back, newest first, as read by WindowView::Windows().
+     *
+     *  \return GetSize() * GetCandleSize() values.
+     */
+
+    template<typename T>
+    std::vector<T> GetCandles() const;
+
+private:
+
+    /**************************************************************************************
+     * Data
+     **************************************************************************************/
+
+    Column<double> v_Columns[5];
+    Column<float> v_ColumnsF[5];
+    Column<int64_t> v_Timestamp;
+
+    bool b_Volume;
+    bool b_Timestamp;
+
+protected:
+
+};
+
+template<>
+const double *OHLCVDataset::GetColumn<double>(Field e_Field) const noexcept;
+
+template<>
+const float *OHLCVDataset::GetColumn<float>(Field e_Field) const noexcept;
+
+#endif /* OHLCVDataset_hpp */
@@ -13,12 +13,15 @@
 #include <cstdio>
 #include <vector>
 #include <iostream>
+#include <fstream>
 #include <string>
+#include <stdexcept>
 
 // External
 #include <convertcsv.hpp>
 
 // Project
+#include "./OHLCVDataset.hpp"
 
 
 namespace OHLCVManager {
@@ -43,7 +46,8 @@ namespace OHLCVManager {
         std::vector<std::vector<double>> data = ConvertCSV::Convert(s_filepath, ',');
 
 
-        for (size_t i = data.size() - 1; i >= us_window_size; --i)
+        // Counts down to us_window_size, i >= 0 would never end for a window of 0
+        for (size_t i = data.size(); i-- > us_window_size;)
         {
             for (size_t j = 1; j <= us_window_size; ++j)
             {
@@ -72,6 +76,115 @@ namespace OHLCVManager {
         return data;
     }
 
+    /**
+     *  Copy the rows of a dataset into one contiguous row-major buffer.
+     *
+     *  \param v_Data The dataset, all rows must have the same length.
+     *
+     *  \return The rows back to back, row i starts at i * v_Data[0].size().
+     */
+
+    std::vector<double> flatten(const std::vector<std::vector<double>> &v_Data) {
+        std::vector<double> v_Rows;
+
+        if (v_Data.empty()) {
+            return v_Rows;
+        }
+
+        v_Rows.reserve(v_Data.size() * v_Data[0].size());
+        for (auto &it_row : v_Data) {
+            v_Rows.insert(v_Rows.end(), it_row.begin(), it_row.end());
+        }
+
+        return v_Rows;
+    }
+
+    /**
+     *  Get local candles for a WindowView.
+     *
+     *  \param s_filepath The file path to the dataset.
+     *  \param s_Dataset Loaded with the columns of the file.
+     *
+     *  \return The candles back to back, newest first, so windows of previous candles are contiguous.
+     */
+
+    std::vector<double> getlocalCandles(std::string s_filepath, OHLCVDataset &s_Dataset) {
+        std::cout << "Loading Dataset..." << std::endl;
+
+        s_Dataset.Load(s_filepath);
+
+        std::cout << "Finished Loading Dataset" << std::endl;
+
+        return s_Dataset.GetCandles<double>();
+    }
+
+    /**
+     *  Get the datasets of a path. A path not ending in .csv is a manifest, a text file
+     *  with one dataset per line, relative to the directory of the manifest. Empty lines
+     *  and lines starting with # are skipped.
+     *
+     *  \param s_filepath The file path to a dataset or a manifest.
+     *
+     *  \return The file paths of the datasets.
+     */
+
+    std::vector<std::string> getDatasetPaths(std::string s_filepath) {
+        std::vector<std::string> v_Paths;
+
+        if (s_filepath.size() >= 4 && s_filepath.compare(s_filepath.size() - 4, 4, ".csv") == 0) {
+            v_Paths.push_back(s_filepath);
+            return v_Paths;
+        }
+
+        std::ifstream fs_Manifest(s_filepath);
+        if (!fs_Manifest.is_open()) {
+            throw std::runtime_error("Could not open dataset manifest " + s_filepath);
+        }
+
+        size_t us_Slash = s_filepath.find_last_of('/');
+        std::string s_Directory = us_Slash == std::string::npos ? "" : s_filepath.substr(0, us_Slash + 1);
+        std::string s_Line;
+
+        while (std::getline(fs_Manifest, s_Line)) {
+            // Trim, the manifest may have Windows line ends
+            size_t us_Begin = s_Line.find_first_not_of(" \t\r");
+            if (us_Begin == std::string::npos || s_Line[us_Begin] == '#') {
+                continue;
+            }
+            s_Line = s_Line.substr(us_Begin, s_Line.find_last_not_of(" \t\r") - us_Begin + 1);
+
+            v_Paths.push_back(s_Line[0] == '/' ? s_Line : s_Directory + s_Line);
+        }
+
+        if (v_Paths.empty()) {
+            throw std::runtime_error("No datasets in manifest " + s_filepath);
+        }
+
+        return v_Paths;
+    }
+
+    /**
+     *  Get the validation set of a train set, "train" in the file name replaced by "validate",
+     *  e.g. XRP-USD-train.csv -> XRP-USD-validate.csv.
+     *
+     *  \param s_filepath The file path to the train set.
+     *
+     *  \return The file path of the validation set, empty if there is none.
+     */
+
+    std::string getValidationPath(std::string s_filepath) {
+        size_t us_Slash = s_filepath.find_last_of('/');
+        size_t us_Train = s_filepath.rfind("train");
+
+        if (us_Train == std::string::npos || (us_Slash != std::string::npos && us_Train < us_Slash)) {
+            return "";
+        }
+
+        std::string s_Validate = s_filepath.substr(0, us_Train) + "validate" + s_filepath.substr(us_Train + 5);
+
+        return std::ifstream(s_Validate).good() ? s_Validate : "";
+    }
+
     /**
      *  Get local OHLCV delta.
      *
@@ -86,7 +199,8 @@ namespace OHLCVManager {
         std::cerr << "Loading Dataset..." << std::endl;
         std::vector<std::vector<double>> data = ConvertCSV::Convert(s_filepath, ',');
 
-        for (size_t i = data.size() - 1; i >= us_window_size; --i)
+        // Counts down to us_window_size, i >= 0 would never end for a window of 0
+        for (size_t i = data.size(); i-- > us_window_size;)
         {
             for (size_t j = 1; j <= us_window_size; ++j)
             {
@@ -0,0 +1,647 @@
+//
+//  PositionSimulator.hpp
+//  CNT
+//
+
+#ifndef PositionSimulator_hpp
+#define PositionSimulator_hpp
+
+// C / C++
+#include <cstddef>
+#include <cmath>
+#include <vector>
+
+// External
+
+// Project
+
+
+/**
+ *  State of the account of one genome during a backtest.
+ */
+
+struct Position {
+    double f64_Money; // Free money
+    double f64_Quantity; // Held units, > 0 == long, < 0 == short, 0 == no position
+    double f64_OpenPrice; // Close price the position was opened at
+    double f64_Value; // Money bound in the position
+    double f64_Liquidation; // Price the position is liquidated at
+    int i_Actions; // Long or short actions taken
+};
+
+
+/**
+ *  Running sums of the trade metrics of one backtest, updated on every candle.
+ *  Equity is the money with the open position valued at the close.
+ */
+
+struct TradeMetrics {
+    double f64_LastEquity; // Equity after the last candle
+    double f64_PeakEquity; // Highest equity so far
+    double f64_MaxDrawdown; // Largest fall below the peak, 0.1 == 10%
+    double f64_ReturnSum; // Sum of the equity returns per candle
+    double f64_ReturnSquares; // Sum of the squared returns
+    double f64_EntryEquity; // Equity after the open trade was opened
+    size_t us_Candles; // Candles seen
+    size_t us_Exposed; // Candles with an open position
+    int i_Trades; // Closed or liquidated trades
+    int i_Wins; // Trades which ended above their entry equity
+};
+
+
+/**************************************************************************************
+ * Fee models
+ * ----------
+ * Fee(f64_Notional) is the fee of a trade of f64_Notional money.
+ **************************************************************************************/
+
+/**
+ *  No fees.
+ */
+
+class NoFee {
+public:
+
+    explicit NoFee(double) noexcept {}
+
+    double operator()(double) const noexcept {
+        return 0.0;
+    }
+};
+
+/**
+ *  A fixed part of the traded money, e.g. 0.00125 == 0.125%.
+ */
+
+class NotionalFee {
+public:
+
+    explicit NotionalFee(double f64_Fee) noexcept : f64_Fee(f64_Fee) {}
+
+    double operator()(double f64_Notional) const noexcept {
+        return f64_Notional * f64_Fee;
+    }
+
+private:
+
+    double f64_Fee;
+};
+
+
+/**************************************************************************************
+ * Position sizing
+ * ---------------
+ * Open() and Close() book a position, Profit() is its unrealized profit at a close price
+ * and Equity() the money with the position closed at that price, fees aside.
+ **************************************************************************************/
+
+/**
+ *  Lot based forex contracts of 100000 units. The money stays free while a position is open,
+ *  the profit is added when it is closed.
+ */
+
+class LotSizing {
+public:
+
+    /**
+     *  Constructor.
+     *
+     *  \param f64_Leverage Leverage of a position.
+     *  \param f64_Exposure Part of the money used for a position.
+     */
+
+    LotSizing(double f64_Leverage, double f64_Exposure) noexcept
+            : f64_Leverage(f64_Leverage), f64_Exposure(f64_Exposure) {}
+
+    double Profit(const Position &s_Position, double f64_Close) const noexcept {
+        return (f64_Close - s_Position.f64_OpenPrice) * (100000.0 * s_Position.f64_Quantity);
+    }
+
+    double Equity(const Position &s_Position, double f64_Close) const noexcept {
+        return s_Position.f64_Money + Profit(s_Position, f64_Close);
+    }
+
+    template<class Fee>
+    void Open(Position &s_Position, int i_Action, double f64_Close, const Fee &s_Fee) const noexcept {
+        s_Position.f64_Quantity = (((s_Position.f64_Money * f64_Exposure) * f64_Leverage) / 100000) *
+                                  static_cast<double>(i_Action);
+        s_Position.f64_OpenPrice = f64_Close;
+        s_Position.f64_Money -= s_Fee(std::fabs(s_Position.f64_Quantity) * 100000.0 * f64_Close);
+    }
+
+    template<class Fee>
+    void Close(Position &s_Position, double f64_Profit, double f64_Close, const Fee &s_Fee) const noexcept {
+        s_Position.f64_Money += f64_Profit;
+        s_Position.f64_Money -= s_Fee(std::fabs(s_Position.f64_Quantity) * 100000.0 * f64_Close);
+        s_Position.f64_Quantity = 0.0;
+        s_Position.f64_OpenPrice = 0.0;
+    }
+
+private:
+
+    double f64_Leverage;
+    double f64_Exposure;
+};
+
+/**
+ *  Leveraged margin trading. The margin is taken from the money while the position is open,
+ *  the position is f64_Leverage times the margin. The liquidation level is the price at
+ *  which the loss equals the margin.
+ */
+
+class MarginSizing {
+public:
+
+    /**
+     *  Constructor.
+     *
+     *  \param f64_Leverage Leverage of a position.
+     *  \param f64_Exposure Part of the money used as margin.
+     */
+
+    MarginSizing(double f64_Leverage, double f64_Exposure) noexcept
+            : f64_Leverage(f64_Leverage), f64_Exposure(f64_Exposure) {}
+
+    double Profit(const Position &s_Position, double f64_Close) const noexcept {
+        return (f64_Close - s_Position.f64_OpenPrice) * s_Position.f64_Quantity;
+    }
+
+    double Equity(const Position &s_Position, double f64_Close) const noexcept {
+        return s_Position.f64_Money + s_Position.f64_Value + Profit(s_Position, f64_Close);
+    }
+
+    template<class Fee>
+    void Open(Position &s_Position, int i_Action, double f64_Close, const Fee &s_Fee) const noexcept {
+        double f64_Margin = s_Position.f64_Money * f64_Exposure;
+        double f64_Action = static_cast<double>(i_Action);
+
+        s_Position.f64_Money -= f64_Margin;
+        s_Position.f64_Money -= s_Fee(f64_Margin * f64_Leverage);
+        s_Position.f64_Value = f64_Margin;
+        s_Position.f64_Quantity = ((f64_Margin * f64_Leverage) / f64_Close) * f64_Action;
+        s_Position.f64_OpenPrice = f64_Close;
+        s_Position.f64_Liquidation = f64_Close * (1.0 - f64_Action / f64_Leverage);
+    }
+
+    template<class Fee>
+    void Close(Position &s_Position, double f64_Profit, double f64_Close, const Fee &s_Fee) const noexcept {
+        s_Position.f64_Money += s_Position.f64_Value + f64_Profit;
+        s_Position.f64_Money -= s_Fee(std::fabs(s_Position.f64_Quantity) * f64_Close);
+        s_Position.f64_Quantity = 0.0;
+        s_Position.f64_OpenPrice = 0.0;
+        s_Position.f64_Value = 0.0;
+        s_Position.f64_Liquidation = 0.0;
+    }
+
+private:
+
+    double f64_Leverage;
+    double f64_Exposure;
+};
+
+
+/**************************************************************************************
+ * Liquidation models
+ * ------------------
+ * Apply() closes a position by force before the action of a candle is taken.
+ **************************************************************************************/
+
+/**
+ *  A position is closed early once its profit exceeds half the free money.
+ *  The check is a select, not a branch, it runs on every candle.
+ */
+
+class ProfitLimit {
+public:
+
+    template<class Sizing, class Fee>
+    void Apply(Position &s_Position, double f64_Profit, double, const Sizing &, const Fee &) const noexcept {
+        // 0 with no position
+        bool b_Liquidate = f64_Profit > s_Position.f64_Money / 2.0;
+        s_Position.f64_Money += b_Liquidate ? f64_Profit : 0.0;
+        s_Position.f64_Quantity = b_Liquidate ? 0.0 : s_Position.f64_Quantity;
+        s_Position.f64_OpenPrice = b_Liquidate ? 0.0 : s_Position.f64_OpenPrice;
+    }
+};
+
+/**
+ *  A short position is liquidated once the close is above its liquidation level, a long
+ *  one once the close is below. The margin is lost and the fee is paid on the position.
+ */
+
+class MarginCall {
+public:
+
+    template<class Sizing, class Fee>
+    void Apply(Position &s_Position, double, double f64_Close, const Sizing &, const Fee &s_Fee) const noexcept {
+        if ((s_Position.f64_Quantity < 0.0 && s_Position.f64_Liquidation < f64_Close) ||
+            (s_Position.f64_Quantity > 0.0 && f64_Close < s_Position.f64_Liquidation)) {
+            s_Position.f64_Money -= s_Fee(std::fabs(s_Position.f64_Quantity) * f64_Close);
+            s_Position.f64_Quantity = 0.0;
+            s_Position.f64_OpenPrice = 0.0;
+            s_Position.f64_Value = 0.0;
+            s_Position.f64_Liquidation = 0.0;
+        }
+    }
+};
+
+
+/**
+ *  Trading rules composed of a fee model, a liquidation model and a position sizing.
+ *  The policies are template parameters, every market gets its own inlined Step().
+ */
+
+template<class Fee, class Liquidation, class Sizing>
+class TradingMarket {
+public:
+
+    /**
+     *  Constructor.
+     *
+     *  \param f64_Leverage Leverage of a position.
+     *  \param f64_Exposure Part of the money used for a position.
+     *  \param f64_Fee Trade fee, 0.00125 == 0.125%.
+     */
+
+    TradingMarket(double f64_Leverage, double f64_Exposure, double f64_Fee) noexcept
+            : s_Fee(f64_Fee), s_Sizing(f64_Leverage, f64_Exposure) {}
+
+    /**
+     *  Apply one action at a close price.
+     *  Closing a long and a short position are the same update, the sign of the quantity
+     *  gives the direction.
+     *
+     *  \param s_Position The account.
+     *  \param i_Action 1 == long ; -1 == short; 0 == nothing
+     *  \param f64_Close Close price.
+     *
+     *  \return True if the position held before was closed or liquidated, a new one can
+     *          be open afterwards.
+     */
+
+    bool Step(Position &s_Position, int i_Action, double f64_Close) const noexcept {
+        double f64_Profit = s_Sizing.Profit(s_Position, f64_Close);
+        bool b_Held = s_Position.f64_Quantity != 0.0;
+
+        s_Liquidation.Apply(s_Position, f64_Profit, f64_Close, s_Sizing, s_Fee);
+        bool b_Closed = b_Held && s_Position.f64_Quantity == 0.0;
+
+        // Open a position in the direction of the action, or close one against it.
+        // Trades are rare next to candles, so these branches are well predicted.
+        if (i_Action != 0 && s_Position.f64_Quantity == 0.0) {
+            s_Sizing.Open(s_Position, i_Action, f64_Close, s_Fee);
+        } else if (s_Position.f64_Quantity * static_cast<double>(i_Action) < 0.0) {
+            s_Sizing.Close(s_Position, f64_Profit, f64_Close, s_Fee);
+            b_Closed = true;
+        }
+
+        return b_Closed;
+    }
+
+    /**
+     *  Get the equity of an account.
+     *
+     *  \param s_Position The account.
+     *  \param f64_Close Close price.
+     *
+     *  \return The money with the position valued at the close price.
+     */
+
+    double Equity(const Position &s_Position, double f64_Close) const noexcept {
+        return s_Sizing.Equity(s_Position, f64_Close);
+    }
+
+private:
+
+    Fee s_Fee;
+    Liquidation s_Liquidation;
+    Sizing s_Sizing;
+};
+
+// Lot based forex contracts of 100000 units, no fees
+typedef TradingMarket<NoFee, ProfitLimit, LotSizing> ForexMarket;
+
+// Leveraged crypto margin trading, the fee is paid on the leveraged position
+typedef TradingMarket<NotionalFee, MarginCall, MarginSizing> CryptoMarket;
+
+
+/**************************************************************************************
+ * Trade logs
+ * ----------
+ * Record() is called after every candle with the account, the action, the close and the equity.
+ **************************************************************************************/
+
+/**
+ *  Nothing is recorded, the calls are inlined away. Used by the evaluation.
+ */
+
+class NoTradeLog {
+public:
+
+    void Record(const Position &, int, double, double) noexcept {}
+};
+
+/**
+ *  One candle of a TradeLog.
+ */
+
+struct TradeLogEntry {
+    int i_Action; // 1 == long ; -1 == short; 0 == nothing
+    double f64_Close;
+    double f64_Quantity; // Held units after the action
+    double f64_Equity;
+};
+
+/**
+ *  Every candle is recorded, e.g. to export the trades and the equity curve of a winner.
+ */
+
+class TradeLog {
+public:
+
+    void Record(const Position &s_Position, int i_Action, double f64_Close, double f64_Equity) {
+        v_Entries.push_back({i_Action, f64_Close, s_Position.f64_Quantity, f64_Equity});
+    }
+
+    const std::vector<TradeLogEntry> &GetEntries() const noexcept {
+        return v_Entries;
+    }
+
+private:
+
+    std::vector<TradeLogEntry> v_Entries;
+};
+
+
+/**
+ *  Trade simulation over a series of actions and the matching close prices.
+ *  The actions come from a network beforehand, the simulator only moves money, so one
+ *  series can be run in any number of pieces.
+ *
+ *  The trade metrics are kept as running sums, one pass gives the profit, the Sharpe ratio,
+ *  the drawdown, the win rate and the exposure.
+ *
+ *  Market is the set of trading rules, a TradingMarket like ForexMarket or CryptoMarket.
+ *  Log records the candles, NoTradeLog or TradeLog.
+ */
+
+template<class Market, class Log = NoTradeLog>
+class PositionSimulator {
+public:
+
+    /**************************************************************************************
+     * Constructor / Destructor
+     **************************************************************************************/
+
+    /**
+     *  Constructor.
+     *
+     *  \param s_Market The trading rules.
+     *  \param f64_Capital Starting money.
+     */
+
+    PositionSimulator(const Market &s_Market, double f64_Capital) noexcept
+            : s_Market(s_Market), f64_Capital(f64_Capital) {
+        Reset();
+    }
+
+    /**
+     *  Start again with the starting money and no position.
+     */
+
+    void Reset() noexcept {
+        s_Position = {f64_Capital, 0.0, 0.0, 0.0, 0.0, 0};
+        s_Metrics = {f64_Capital, f64_Capital, 0.0, 0.0, 0.0, 0.0, 0, 0, 0, 0};
+        b_Active = true;
+    }
+
+    /**
+     *  Continue a backtest which was stopped, e.g. after a segment of the dataset.
+     *
+     *  \param s_Position The account when it was stopped.
+     *  \param s_Metrics The trade metrics when it was stopped.
+     *  \param b_Active False if the money was used up.
+     */
+
+    void Resume(const Position &s_Position, const TradeMetrics &s_Metrics, bool b_Active) noexcept {
+        this->s_Position = s_Position;
+        this->s_Metrics = s_Metrics;
+        this->b_Active = b_Active;
+    }
+
+    /**************************************************************************************
+     * Simulate
+     **************************************************************************************/
+
+    /**
+     *  Continue the backtest over the next actions.
+     *
+     *  \param p_Actions us_Count actions, 1 == long ; -1 == short; 0 == nothing
+     *  \param p_Close The close price at every action.
+     *  \param us_Count Number of actions.
+     *
+     *  \return False if the money is used up, the backtest is over.
+     */
+
+    template<typename T>
+    bool Run(const int *p_Actions, const T *p_Close, size_t us_Count) noexcept {
+        for (size_t us_it = 0; us_it < us_Count && b_Active; us_it++) {
+            if (s_Position.f64_Money <= 0) {
+                s_Position.f64_Money = 0;
+                b_Active = false;
+                break;
+            }
+
+            double f64_Close = static_cast<double>(p_Close[us_it]);
+
+            bool b_Held = s_Position.f64_Quantity != 0.0;
+            s_Position.i_Actions += p_Actions[us_it] != 0;
+            bool b_Closed = s_Market.Step(s_Position, p_Actions[us_it], f64_Close);
+
+            double f64_Equity = s_Market.Equity(s_Position, f64_Close);
+            Measure(f64_Equity, b_Closed, s_Position.f64_Quantity != 0.0 && (b_Closed || !b_Held));
+            s_Log.Record(s_Position, p_Actions[us_it], f64_Close, f64_Equity);
+        }
+
+        return b_Active;
+    }
+
+    /**************************************************************************************
+     * Getters
+     **************************************************************************************/
+
+    /**
+     *  Check if the backtest can go on.
+     *
+     *  \return False once the money is used up.
+     */
+
+    bool IsActive() const noexcept {
+        return b_Active;
+    }
+
+    /**
+     *  Get the account.
+     *
+     *  \return The current position and money.
+     */
+
+    const Position &GetPosition() const noexcept {
+        return s_Position;
+    }
+
+    /**
+     *  Get the fitness of the backtest so far.
+     *
+     *  \return Profit in percent of the starting money, -300 if no action was taken.
+     */
+
+    double GetFitness() const noexcept {
+        if (s_Position.i_Actions == 0) {
+            return -300.0;
+        }
+
+        return GetProfit();
+    }
+
+    /**
+     *  Get the profit so far, an open position is not counted.
+     *
+     *  \return Profit in percent of the starting money.
+     */
+
+    double GetProfit() const noexcept {
+        return ((s_Position.f64_Money - f64_Capital) / f64_Capital) * 100.0;
+    }
+
+    /**
+     *  Get the trade metrics, e.g. to resume the backtest later.
+     *
+     *  \return The running sums.
+     */
+
+    const TradeMetrics &GetMetrics() const noexcept {
+        return s_Metrics;
+    }
+
+    /**
+     *  Get the Sharpe ratio of the equity returns per candle over the whole backtest,
+     *  the mean return over its deviation times the square root of the candles.
+     *
+     *  \return The Sharpe ratio, 0 with less than two candles or constant equity.
+     */
+
+    double GetSharpe() const noexcept {
+        if (s_Metrics.us_Candles < 2) {
+            return 0.0;
+        }
+
+        double f64_Candles = static_cast<double>(s_Metrics.us_Candles);
+        double f64_Mean = s_Metrics.f64_ReturnSum / f64_Candles;
+        double f64_Variance = s_Metrics.f64_ReturnSquares / f64_Candles - f64_Mean * f64_Mean;
+
+        if (!(f64_Variance > 0.0)) {
+            return 0.0;
+        }
+
+        return (f64_Mean / std::sqrt(f64_Variance)) * std::sqrt(f64_Candles);
+    }
+
+    /**
+     *  Get the maximum drawdown.
+     *
+     *  \return The largest fall of the equity below its peak, 0.1 == 10%.
+     */
+
+    double GetMaxDrawdown() const noexcept {
+        return s_Metrics.f64_MaxDrawdown;
+    }
+
+    /**
+     *  Get the win rate.
+     *
+     *  \return Part of the ended trades which gained equity, 0 without trades.
+     */
+
+    double GetWinRate() const noexcept {
+        return s_Metrics.i_Trades > 0 ? static_cast<double>(s_Metrics.i_Wins) / s_Metrics.i_Trades : 0.0;
+    }
+
+    /**
+     *  Get the exposure.
+     *
+     *  \return Part of the candles with an open position.
+     */
+
+    double GetExposure() const noexcept {
+        return s_Metrics.us_Candles > 0 ? static_cast<double>(s_Metrics.us_Exposed) / s_Metrics.us_Candles : 0.0;
+    }
+
+    /**
+     *  Get the log.
+     *
+     *  \return The recorded candles.
+     */
+
+    const Log &GetLog() const noexcept {
+        return s_Log;
+    }
+
+private:
+
+    /**************************************************************************************
+     * Metrics
+     **************************************************************************************/
+
+    /**
+     *  Add a candle to the trade metrics, constant time.
+     *
+     *  \param f64_Equity Equity after the action of the candle.
+     *  \param b_Closed True if the trade held before the candle was closed or liquidated.
+     *  \param b_Opened True if a trade was opened, also right after one was closed.
+     */
+
+    void Measure(double f64_Equity, bool b_Closed, bool b_Opened) noexcept {
+        // A forex account can have negative equity with money left
+        double f64_Return = s_Metrics.f64_LastEquity > 0.0 ? f64_Equity / s_Metrics.f64_LastEquity - 1.0 : 0.0;
+
+        s_Metrics.f64_ReturnSum += f64_Return;
+        s_Metrics.f64_ReturnSquares += f64_Return * f64_Return;
+        s_Metrics.f64_LastEquity = f64_Equity;
+
+        // Divide only on a new low
+        if (f64_Equity > s_Metrics.f64_PeakEquity) {
+            s_Metrics.f64_PeakEquity = f64_Equity;
+        } else if (s_Metrics.f64_PeakEquity - f64_Equity > s_Metrics.f64_MaxDrawdown * s_Metrics.f64_PeakEquity) {
+            s_Metrics.f64_MaxDrawdown = (s_Metrics.f64_PeakEquity - f64_Equity) / s_Metrics.f64_PeakEquity;
+        }
+
+        ++s_Metrics.us_Candles;
+        s_Metrics.us_Exposed += s_Position.f64_Quantity != 0.0;
+
+        // Both on one candle when a trade is liquidated and the next opened at once
+        if (b_Closed) {
+            ++s_Metrics.i_Trades;
+            s_Metrics.i_Wins += f64_Equity > s_Metrics.f64_EntryEquity;
+        }
+        if (b_Opened) {
+            s_Metrics.f64_EntryEquity = f64_Equity;
+        }
+    }
+
+    /**************************************************************************************
+     * Data
+     **************************************************************************************/
+
+    Market s_Market;
+    Position s_Position;
+    TradeMetrics s_Metrics;
+    Log s_Log;
+    double f64_Capital;
+    bool b_Active;
+
+protected:
+
+};
+
+#endif /* PositionSimulator_hpp */
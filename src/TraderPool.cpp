@@ -7,6 +7,11 @@
 //
 
 // C / C++
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
 
 // External
 
@@ -20,7 +25,18 @@
  * Called on new and delete.
  **************************************************************************************/
 
-TraderPool::TraderPool(std::string home_dir, int i_Input, int i_Output, bool recurrent) : s_Pool(home_dir, i_Input, i_Output, recurrent) {
+TraderPool::TraderPool(std::string home_dir, int i_Input, int i_Output, bool recurrent) : s_Pool(home_dir, i_Input, i_Output, recurrent),
+                                                                                          us_GenomeNext(0),
+                                                                                          f64_MeanCost(0.0),
+                                                                                          us_Segments(1), f64_Promotion(1.0),
+                                                                                          v_AssetOrder(1, 0),
+                                                                                          us_FitnessCapacity(0),
+                                                                                          ui_FitnessSeed(cann::ui_HashSeed),
+                                                                                          b_LargestFirst(false),
+                                                                                          us_ChunkNext(0),
+                                                                                          us_ClaimThreads(1),
+                                                                                          us_MinChunk(1),
+                                                                                          p_Workers(NULL) {
     Reset();
 }
 
@@ -32,18 +48,77 @@ TraderPool::~TraderPool() noexcept {}
  * Reset trader pool.
  **************************************************************************************/
 
-void TraderPool::Reset() {
+void TraderPool::Reset(bool b_FitnessCache) {
     s_Mutex.lock();
 
-    if (!s_Pool.species.empty()) {
-        us_currentSpecie = 0;
-    } else {
+    if (s_Pool.species.empty()) {
         throw std::runtime_error("RESET() : Species empty!");
     }
 
     if (!s_Pool.species[0].genomes.empty()) {
-        us_currentGenome = 0;
         us_SpeciesSize = s_Pool.species.size();
+        s_ClaimReport = ClaimReport();
+        s_OptimizationReport = cann::optimization_report();
+        s_CacheReport = cann::cache_report();
+        s_FitnessReport = cann::cache_report();
+        this->b_FitnessCache = b_FitnessCache && us_FitnessCapacity > 0;
+
+        // Genomes to evaluate, the others take the fitness of the cache or of their first copy
+        std::vector<std::pair<cneat::genome *, uint64_t>> v_Evaluate;
+        std::unordered_map<uint64_t, cneat::genome *> m_Queued;
+        v_Copies.clear();
+        v_Population.clear();
+        us_GenomeNext = 0;
+        for (auto &it_Specie : s_Pool.species) {
+            for (auto &it_Genome : it_Specie.genomes) {
+                v_Population.push_back(&it_Genome);
+            }
+        }
+
+        // Keys of all genomes, on all threads
+        std::vector<uint64_t> v_Keys(v_Population.size(), 0);
+        if (this->b_FitnessCache) {
+            ParallelFor(v_Population.size(), 16, [this, &v_Keys](size_t i) {
+                v_Keys[i] = cann::genome_hash(*v_Population[i], ui_FitnessSeed);
+            });
+        }
+
+        for (size_t i = 0; i < v_Population.size(); i++) {
+            if (this->b_FitnessCache) {
+                auto it_Cached = m_FitnessCache.find(v_Keys[i]);
+                if (it_Cached != m_FitnessCache.end()) {
+                    v_Population[i]->fitness = it_Cached->second;
+                    ++s_FitnessReport.hits;
+                    continue;
+                }
+
+                auto it_Queued = m_Queued.emplace(v_Keys[i], v_Population[i]);
+                if (!it_Queued.second) {
+                    v_Copies.push_back(std::make_pair(v_Population[i], it_Queued.first->second));
+                    ++s_FitnessReport.hits;
+                    continue;
+                }
+
+                ++s_FitnessReport.misses;
+            }
+
+            v_Evaluate.push_back(std::make_pair(v_Population[i], v_Keys[i]));
+        }
+
+        // Every genome starts the race on every asset
+        v_Race.clear();
+        for (size_t us_Asset : v_AssetOrder) {
+            for (auto &it_Genome : v_Evaluate) {
+                v_Race.push_back({it_Genome.first, Position(), TradeMetrics(), true, false, us_Asset, 0.0, 0.0,
+                                  it_Genome.second});
+            }
+        }
+        us_Rung = 0;
+        us_SkippedRows = 0;
+        b_Idle = false;
+        f64_TailLatency = 0.0;
+        OrderRace();
+        ChunkRace();
 
     } else {
         throw std::runtime_error("RESET() : Genomes of species empty!");
@@ -77,24 +152,611 @@ cneat::genome *TraderPool::GetGenome(size_t us_Specie, size_t us_Genome) noexcep
 }
 
 cneat::genome *TraderPool::GetNextGenome() noexcept {
+    size_t us_Genome = us_GenomeNext.fetch_add(1, std::memory_order_relaxed);
+
+    return us_Genome < v_Population.size() ? v_Population[us_Genome] : NULL;
+}
+
+size_t TraderPool::GetNextGenomes(std::vector<cneat::genome *> &v_Genomes, size_t us_Count) noexcept {
+    size_t us_Begin = us_GenomeNext.fetch_add(us_Count, std::memory_order_relaxed);
+    size_t us_Claimed = us_Begin < v_Population.size() ? std::min(us_Count, v_Population.size() - us_Begin) : 0;
+
+    if (us_Claimed > 0) {
+        std::copy(v_Population.begin() + us_Begin, v_Population.begin() + us_Begin + us_Claimed, v_Genomes.begin());
+    }
+
+    return us_Claimed;
+}
+
+size_t TraderPool::GetNextRaceEntries(RaceClaim &s_Claim, std::vector<RaceEntry *> &v_Entries,
+                                      size_t us_Count) noexcept {
+    size_t us_Claimed = 0;
+
+    // Take the next chunk, the plan of the rung is only written between evaluations
+    if (s_Claim.us_Next >= s_Claim.us_End) {
+        size_t us_Chunk = us_ChunkNext.fetch_add(1, std::memory_order_relaxed);
+
+        if (us_Chunk + 1 < v_RaceChunks.size()) {
+            s_Claim.us_Next = v_RaceChunks[us_Chunk];
+            s_Claim.us_End = v_RaceChunks[us_Chunk + 1];
+            ++s_Claim.us_Chunks;
+        }
+    }
+
+    // Largest first, a claim costs at most an average one, the large genomes are claimed alone
+    double f64_Budget = f64_MeanCost * us_Count;
+    double f64_Cost = 0.0;
+
+    // The genomes of a chunk share the rows of one asset
+    while (us_Claimed < us_Count && s_Claim.us_Next < s_Claim.us_End) {
+        if (!v_RaceCost.empty()) {
+            f64_Cost += v_RaceCost[v_RaceOrder[s_Claim.us_Next]];
+            if (us_Claimed > 0 && f64_Cost > f64_Budget) {
+                break;
+            }
+        }
+
+        v_Entries[us_Claimed++] = &v_Race[v_RaceOrder[s_Claim.us_Next++]];
+    }
+
+    if (us_Claimed > 0) {
+        ++s_Claim.us_Groups;
+        return us_Claimed;
+    }
+
+    // Every thread ends its rung with an empty claim
+    std::unique_lock<std::mutex> s_Lock(s_Mutex, std::try_to_lock);
+    if (!s_Lock.owns_lock()) {
+        s_Lock.lock();
+        ++s_ClaimReport.us_Contended;
+    }
+
+    s_LastIdle = std::chrono::steady_clock::now();
+    if (!b_Idle) {
+        s_FirstIdle = s_LastIdle;
+        b_Idle = true;
+    }
+
+    return 0;
+}
+
+/**************************************************************************************
+ * Racing
+ * ------
+ * Successive halving over segments of the dataset.
+ **************************************************************************************/
+
+void TraderPool::SetRacing(size_t us_Segments, double f64_Promotion) noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    this->us_Segments = std::max<size_t>(us_Segments, 1);
+    this->f64_Promotion = f64_Promotion;
+}
+
+void TraderPool::GetRaceSegment(size_t us_Rows, size_t &us_Begin, size_t &us_End) noexcept {
+    us_Begin = us_Rows * us_Rung / us_Segments;
+    us_End = us_Rows * (us_Rung + 1) / us_Segments;
+}
+
+bool TraderPool::NextRung(size_t us_Rows) {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    if (b_Idle) {
+        f64_TailLatency += std::chrono::duration<double>(s_LastIdle - s_FirstIdle).count();
+        b_Idle = false;
+    }
+
+    WriteFitness();
+
+    if (us_Rung + 1 >= us_Segments || v_AssetOrder.size() > 1) {
+        FinishRace();
+        return false;
+    }
+
+    size_t us_End = us_Rows * (us_Rung + 1) / us_Segments;
+
+    // Genomes without money are done, their fitness is final
+    for (auto &it_Entry : v_Race) {
+        if (!it_Entry.b_Active) {
+            CacheFitness(it_Entry);
+        }
+    }
+    v_Race.erase(std::remove_if(v_Race.begin(), v_Race.end(), [](const RaceEntry &s_Entry) {
+        return !s_Entry.b_Active;
+    }), v_Race.end());
+
+    std::stable_sort(v_Race.begin(), v_Race.end(), [](const RaceEntry &s_A, const RaceEntry &s_B) {
+        return s_A.p_Genome->fitness > s_B.p_Genome->fitness;
+    });
+
+    size_t us_Promoted = static_cast<size_t>(std::ceil(f64_Promotion * v_Race.size()));
+    us_Promoted = std::min(std::max<size_t>(us_Promoted, 1), v_Race.size());
+
+    for (size_t i = us_Promoted; i < v_Race.size(); i++) {
+        double &f64_Fitness = v_Race[i].p_Genome->fitness;
+        double f64_Profit = v_Race[i].f64_Profit;
+
+        // No action yet keeps the penalty. A loss scales with the rows, the metric terms
+        // of the fitness are rates and stay.
+        if (v_Race[i].b_Acted && f64_Profit < 0 && us_End > 0) {
+            f64_Fitness = (f64_Fitness - f64_Profit) + f64_Profit * static_cast<double>(us_Rows) / us_End;
+        }
+
+        us_SkippedRows += us_Rows - us_End;
+    }
+
+    v_Race.resize(us_Promoted);
+    ++us_Rung;
+    OrderRace();
+    ChunkRace();
+
+    if (v_Race.empty()) {
+        FinishRace();
+        return false;
+    }
+
+    return true;
+}
+
+size_t TraderPool::GetSkippedRows() noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    return us_SkippedRows;
+}
+
+/**************************************************************************************
+ * Scheduling
+ * ----------
+ * The order the race entries are claimed in.
+ **************************************************************************************/
+
+void TraderPool::SetScheduling(bool b_LargestFirst) noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    this->b_LargestFirst = b_LargestFirst;
+}
+
+double TraderPool::GetTailLatency() noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    return f64_TailLatency;
+}
+
+void TraderPool::SetClaiming(size_t us_Threads, size_t us_MinChunk) noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    us_ClaimThreads = std::max<size_t>(us_Threads, 1);
+    this->us_MinChunk = std::max<size_t>(us_MinChunk, 1);
+}
+
+void TraderPool::AddClaimReport(const RaceClaim &s_Claim) noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    s_ClaimReport.us_Chunks += s_Claim.us_Chunks;
+    s_ClaimReport.us_Groups += s_Claim.us_Groups;
+}
+
+ClaimReport TraderPool::GetClaimReport() noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    return s_ClaimReport;
+}
+
+/**************************************************************************************
+ * Workers
+ * -------
+ * Tasks of the pool and of the evolution.
+ **************************************************************************************/
+
+void TraderPool::SetWorkers(WorkerPool *p_Workers) {
     std::lock_guard<std::mutex> s_Guard(s_Mutex);
 
-    if (us_currentSpecie >= s_Pool.species.size()) {
-        return NULL;
+    this->p_Workers = p_Workers;
+
+    if (p_Workers) {
+        s_Pool.parallel_for = [p_Workers](size_t us_Count, const std::function<void(size_t)> &f_Task) {
+            p_Workers->ParallelFor(0, us_Count, 1, [&f_Task](size_t us_Begin, size_t us_End) {
+                for (size_t i = us_Begin; i < us_End; i++) {
+                    f_Task(i);
+                }
+            });
+        };
+    } else {
+        s_Pool.parallel_for = nullptr;
+    }
+}
+
+void TraderPool::ParallelFor(size_t us_Count, size_t us_Grain, const std::function<void(size_t)> &f_Task) {
+    if (!p_Workers) {
+        for (size_t i = 0; i < us_Count; i++) {
+            f_Task(i);
+        }
+        return;
+    }
+
+    p_Workers->ParallelFor(0, us_Count, us_Grain, [&f_Task](size_t us_Begin, size_t us_End) {
+        for (size_t i = us_Begin; i < us_End; i++) {
+            f_Task(i);
+        }
+    });
+}
+
+void TraderPool::OrderRace() {
+    v_RaceOrder.resize(v_Race.size());
+    std::iota(v_RaceOrder.begin(), v_RaceOrder.end(), 0);
+    v_RaceCost.clear();
+
+    if (!b_LargestFirst || v_Race.empty()) {
+        return;
     }
 
-    if (us_currentGenome >= s_Pool.species[us_currentSpecie].genomes.size()) {
-        if ((++us_currentSpecie) >= s_Pool.species.size()) {
-            return NULL;
+    // Estimated cost, the size of the phenotype times the rows of the asset
+    std::vector<double> &v_Cost = v_RaceCost;
+    v_Cost.resize(v_Race.size());
+    ParallelFor(v_Race.size(), 16, [this, &v_Cost](size_t i) {
+        size_t us_Rows = v_Race[i].us_Asset < v_AssetRows.size() ? v_AssetRows[v_Race[i].us_Asset] : 1;
+
+        v_Cost[i] = GetPhenotypeSize(*v_Race[i].p_Genome) * us_Rows;
+    });
+    f64_MeanCost = std::accumulate(v_Cost.begin(), v_Cost.end(), 0.0) / v_Cost.size();
+
+    // Reset() queues the entries asset by asset, the blocks stay together for the lockstep claims
+    size_t us_End;
+    for (size_t us_Begin = 0; us_Begin < v_RaceOrder.size(); us_Begin = us_End) {
+        us_End = us_Begin + 1;
+        while (us_End < v_RaceOrder.size() && v_Race[us_End].us_Asset == v_Race[us_Begin].us_Asset) {
+            ++us_End;
         }
 
-        us_currentGenome = 0;
+        std::stable_sort(v_RaceOrder.begin() + us_Begin, v_RaceOrder.begin() + us_End, [&v_Cost](size_t a, size_t b) {
+            return v_Cost[a] > v_Cost[b];
+        });
     }
+}
+
+void TraderPool::ChunkRace() {
+    // Guided chunks, each half of an even share of the work left, every entry costs 1 without estimates
+    double f64_Left = v_RaceCost.empty() ? static_cast<double>(v_Race.size())
+                                         : std::accumulate(v_RaceCost.begin(), v_RaceCost.end(), 0.0);
+    size_t us_Next = 0;
+    v_RaceChunks.clear();
+    while (us_Next < v_RaceOrder.size()) {
+        size_t us_Begin = us_Next;
+        size_t us_Asset = v_Race[v_RaceOrder[us_Begin]].us_Asset;
+        double f64_Share = f64_Left / (2 * us_ClaimThreads);
+        double f64_Chunk = 0.0;
+
+        while (us_Next < v_RaceOrder.size() && v_Race[v_RaceOrder[us_Next]].us_Asset == us_Asset &&
+               (us_Next - us_Begin < us_MinChunk || f64_Chunk < f64_Share)) {
+            f64_Chunk += v_RaceCost.empty() ? 1.0 : v_RaceCost[v_RaceOrder[us_Next]];
+            ++us_Next;
+        }
 
-    cneat::genome *p_Result = &(s_Pool.species[us_currentSpecie].genomes[us_currentGenome]);
-    ++us_currentGenome;
+        f64_Left -= f64_Chunk;
+        v_RaceChunks.push_back(us_Begin);
+    }
+    v_RaceChunks.push_back(us_Next);
+    us_ChunkNext = 0;
+}
+
+double TraderPool::GetPhenotypeSize(const cneat::genome &s_Genome) {
+    // Nodes fed by an input and nodes feeding an output
+    std::unordered_set<int> s_Fed(s_Genome.input_pins.begin(), s_Genome.input_pins.end());
+    std::unordered_set<int> s_Feeding(s_Genome.output_pins.begin(), s_Genome.output_pins.end());
+    bool b_Changed = true;
+
+    while (b_Changed) {
+        b_Changed = false;
+
+        for (auto &it_Connection : s_Genome.connection_genes) {
+            if (!it_Connection.enabled) {
+                continue;
+            }
+            int i_To = static_cast<int>(it_Connection.to_node);
+
+            if (s_Fed.count(it_Connection.from_node) > 0 && s_Fed.insert(i_To).second) {
+                b_Changed = true;
+            }
+            if (s_Feeding.count(i_To) > 0 && s_Feeding.insert(it_Connection.from_node).second) {
+                b_Changed = true;
+            }
+        }
+    }
+
+    // Everything else is folded to a constant or removed by optimize()
+    size_t us_Size = s_Genome.output_pins.size();
+    for (auto &it_Connection : s_Genome.connection_genes) {
+        if (it_Connection.enabled && s_Fed.count(it_Connection.from_node) > 0 &&
+            s_Feeding.count(static_cast<int>(it_Connection.to_node)) > 0) {
+            ++us_Size;
+        }
+    }
+    for (auto &it_Node : s_Genome.node_genes) {
+        int i_Key = static_cast<int>(it_Node.key);
+
+        if (it_Node.key >= s_Genome.output_pins.size() && s_Fed.count(i_Key) > 0 && s_Feeding.count(i_Key) > 0) {
+            ++us_Size;
+        }
+    }
+
+    return static_cast<double>(us_Size);
+}
+
+/**************************************************************************************
+ * Assets
+ * ------
+ * Several datasets per genome, the fitness is aggregated.
+ **************************************************************************************/
+
+void TraderPool::SetAssets(const std::vector<size_t> &v_Rows,
+                           std::function<double(const std::vector<double> &)> f_Aggregate) {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    v_AssetRows = v_Rows;
+    v_AssetOrder.resize(std::max<size_t>(v_Rows.size(), 1));
+    for (size_t i = 0; i < v_AssetOrder.size(); i++) {
+        v_AssetOrder[i] = i;
+    }
+    if (!v_Rows.empty()) {
+        std::stable_sort(v_AssetOrder.begin(), v_AssetOrder.end(), [&v_Rows](size_t a, size_t b) {
+            return v_Rows[a] > v_Rows[b];
+        });
+    }
+
+    f_AssetFitness = f_Aggregate;
+}
+
+size_t TraderPool::GetAssetCount() noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    return v_AssetOrder.size();
+}
+
+void TraderPool::WriteFitness() {
+    if (v_AssetOrder.size() == 1) {
+        for (auto &it_Entry : v_Race) {
+            it_Entry.p_Genome->fitness = it_Entry.f64_Fitness;
+        }
+
+        return;
+    }
+
+    // Fitness of every genome on every asset
+    std::unordered_map<cneat::genome *, std::vector<double>> m_Fitness;
+    for (auto &it_Entry : v_Race) {
+        std::vector<double> &v_Fitness = m_Fitness[it_Entry.p_Genome];
+        v_Fitness.resize(v_AssetOrder.size());
+        v_Fitness[it_Entry.us_Asset] = it_Entry.f64_Fitness;
+    }
+
+    for (auto &it_Genome : m_Fitness) {
+        if (f_AssetFitness) {
+            it_Genome.first->fitness = f_AssetFitness(it_Genome.second);
+        } else {
+            it_Genome.first->fitness = std::accumulate(it_Genome.second.begin(), it_Genome.second.end(), 0.0) /
+                                       it_Genome.second.size();
+        }
+    }
+}
+
+/**************************************************************************************
+ * Fitness cache
+ * -------------
+ * Unchanged genomes keep their fitness across generations.
+ **************************************************************************************/
+
+void TraderPool::SetFitnessCache(size_t us_Capacity, uint64_t ui_Seed) {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    us_FitnessCapacity = us_Capacity;
+    ui_FitnessSeed = ui_Seed;
+    m_FitnessCache.clear();
+    v_FitnessOrder.clear();
+}
+
+cann::cache_report TraderPool::GetFitnessCacheReport() noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    return s_FitnessReport;
+}
+
+void TraderPool::CacheFitness(const RaceEntry &s_Entry) {
+    if (!b_FitnessCache) {
+        return;
+    }
+
+    // Once per genome, an entry per asset shares the key
+    if (!m_FitnessCache.emplace(s_Entry.ui_Key, s_Entry.p_Genome->fitness).second) {
+        return;
+    }
+    v_FitnessOrder.push_back(s_Entry.ui_Key);
+
+    while (v_FitnessOrder.size() > us_FitnessCapacity) {
+        m_FitnessCache.erase(v_FitnessOrder.front());
+        v_FitnessOrder.pop_front();
+        ++s_FitnessReport.evictions;
+    }
+}
+
+void TraderPool::FinishRace() {
+    // The losers of a race are left out, their fitness is an estimate
+    for (auto &it_Entry : v_Race) {
+        CacheFitness(it_Entry);
+    }
+
+    for (auto &it_Copy : v_Copies) {
+        it_Copy.first->fitness = it_Copy.second->fitness;
+    }
+}
+
+/**************************************************************************************
+ * Mini-batch
+ * ----------
+ * Random windows of the dataset, shared by all genomes of a generation.
+ **************************************************************************************/
+
+void TraderPool::DrawWindows(size_t us_Rows, size_t us_Count, size_t us_Length) {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    v_Windows.clear();
+    us_Length = std::min(us_Length, us_Rows);
+    if (us_Length == 0) {
+        return;
+    }
+
+    std::uniform_int_distribution<size_t> s_Start(0, us_Rows - us_Length);
+    for (size_t i = 0; i < us_Count; i++) {
+        size_t us_Start = s_Start(s_Pool.generator);
+        v_Windows.push_back(std::make_pair(us_Start, us_Start + us_Length));
+    }
+}
+
+void TraderPool::ClearWindows() noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    v_Windows.clear();
+}
+
+std::vector<std::pair<size_t, size_t>> TraderPool::GetWindows() {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    return v_Windows;
+}
+
+void TraderPool::SetChampionScore(std::function<double(cneat::genome &)> f_Score) {
+    s_Pool.champion_score = f_Score;
+}
+
+void TraderPool::SetNewBest(std::function<void(const cneat::genome &, unsigned int)> f_NewBest) {
+    s_Pool.on_new_best = f_NewBest;
+}
+
+std::vector<double> TraderPool::GetFitness() noexcept {
+    std::vector<double> v_Fitness;
+
+    for (auto &it_Specie : s_Pool.species) {
+        for (auto &it_Genome : it_Specie.genomes) {
+            v_Fitness.push_back(it_Genome.fitness);
+        }
+    }
+
+    return v_Fitness;
+}
+
+double TraderPool::GetRankCorrelation(const std::vector<double> &v_A, const std::vector<double> &v_B) {
+    size_t us_Size = std::min(v_A.size(), v_B.size());
+
+    // Average ranks, equal values share one
+    auto rank = [us_Size](const std::vector<double> &v_Values) {
+        std::vector<size_t> v_Order(us_Size);
+        std::vector<double> v_Rank(us_Size);
+
+        for (size_t i = 0; i < us_Size; i++) {
+            v_Order[i] = i;
+        }
+        std::sort(v_Order.begin(), v_Order.end(), [&v_Values](size_t a, size_t b) {
+            return v_Values[a] < v_Values[b];
+        });
+
+        for (size_t i = 0; i < us_Size;) {
+            size_t j = i;
+            while (j + 1 < us_Size && v_Values[v_Order[j + 1]] == v_Values[v_Order[i]]) {
+                ++j;
+            }
+            for (size_t k = i; k <= j; k++) {
+                v_Rank[v_Order[k]] = (i + j) / 2.0;
+            }
+            i = j + 1;
+        }
+
+        return v_Rank;
+    };
+
+    std::vector<double> v_RankA = rank(v_A);
+    std::vector<double> v_RankB = rank(v_B);
+
+    // Pearson correlation of the ranks
+    double f64_MeanA = 0.0;
+    double f64_MeanB = 0.0;
+    for (size_t i = 0; i < us_Size; i++) {
+        f64_MeanA += v_RankA[i];
+        f64_MeanB += v_RankB[i];
+    }
+    f64_MeanA /= us_Size;
+    f64_MeanB /= us_Size;
+
+    double f64_Cov = 0.0;
+    double f64_VarA = 0.0;
+    double f64_VarB = 0.0;
+    for (size_t i = 0; i < us_Size; i++) {
+        f64_Cov += (v_RankA[i] - f64_MeanA) * (v_RankB[i] - f64_MeanB);
+        f64_VarA += (v_RankA[i] - f64_MeanA) * (v_RankA[i] - f64_MeanA);
+        f64_VarB += (v_RankB[i] - f64_MeanB) * (v_RankB[i] - f64_MeanB);
+    }
+
+    if (f64_VarA <= 0.0 || f64_VarB <= 0.0) {
+        return 0.0;
+    }
+
+    return f64_Cov / std::sqrt(f64_VarA * f64_VarB);
+}
+
+void TraderPool::AddOptimizationReport(const cann::optimization_report &s_Report) noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    s_OptimizationReport.nodes_before += s_Report.nodes_before;
+    s_OptimizationReport.nodes_after += s_Report.nodes_after;
+    s_OptimizationReport.links_before += s_Report.links_before;
+    s_OptimizationReport.links_after += s_Report.links_after;
+    s_OptimizationReport.constants_folded += s_Report.constants_folded;
+    s_OptimizationReport.links_merged += s_Report.links_merged;
+}
+
+cann::optimization_report TraderPool::GetOptimizationReport() noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    return s_OptimizationReport;
+}
+
+void TraderPool::SetPhenotypeCache(size_t us_Capacity) {
+    s_FeedForwardCache.set_capacity(us_Capacity);
+    s_FeedForwardCacheF.set_capacity(us_Capacity);
+    s_RecurrentCache.set_capacity(us_Capacity);
+    s_RecurrentCacheF.set_capacity(us_Capacity);
+}
+
+template<>
+cann::phenotype_cache<cann::basic_feed_forward_network<double>> &TraderPool::GetPhenotypeCache() noexcept {
+    return s_FeedForwardCache;
+}
+
+template<>
+cann::phenotype_cache<cann::basic_feed_forward_network<float>> &TraderPool::GetPhenotypeCache() noexcept {
+    return s_FeedForwardCacheF;
+}
+
+template<>
+cann::phenotype_cache<cann::basic_recurrent_network<double>> &TraderPool::GetPhenotypeCache() noexcept {
+    return s_RecurrentCache;
+}
+
+template<>
+cann::phenotype_cache<cann::basic_recurrent_network<float>> &TraderPool::GetPhenotypeCache() noexcept {
+    return s_RecurrentCacheF;
+}
+
+void TraderPool::AddCacheReport(const cann::cache_report &s_Report) noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    s_CacheReport.hits += s_Report.hits;
+    s_CacheReport.misses += s_Report.misses;
+    s_CacheReport.evictions += s_Report.evictions;
+}
+
+cann::cache_report TraderPool::GetCacheReport() noexcept {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
 
-    return p_Result;
+    return s_CacheReport;
 }
 
 double TraderPool::GetMaxFitness() noexcept {
@@ -13,11 +13,63 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <random>
+#include <utility>
+#include <functional>
+#include <deque>
+#include <unordered_map>
+#include <chrono>
+#include <atomic>
 
 // External
 #include <cann.h>
+#include <cann_recurrent.h>
+#include <cann_cache.h>
 
 // Project
+#include "./PositionSimulator.hpp"
+#include "./WorkerPool.hpp"
+
+
+/**
+ *  A genome on one asset in the race of the current generation and its account after the last segment.
+ */
+
+struct RaceEntry {
+    cneat::genome *p_Genome;
+    Position s_Position;
+    TradeMetrics s_Metrics; // Trade metrics of the account
+    bool b_Active; // False once the money is used up, the fitness is final
+    bool b_Acted; // False until the genome took an action, the fitness is the no-action penalty
+    size_t us_Asset; // Dataset the genome is evaluated on
+    double f64_Fitness; // Fitness on the asset, written to the genome by NextRung()
+    double f64_Profit; // Profit term of the fitness, the part NextRung() extrapolates
+    uint64_t ui_Key; // Fitness cache key of the genome
+};
+
+
+/**
+ *  The chunk of race entries a thread works through, owned by the thread. Zero it at the
+ *  start of every rung.
+ */
+
+struct RaceClaim {
+    size_t us_Next; // Next position of the chunk in the claim order
+    size_t us_End; // One past the last position of the chunk
+    size_t us_Chunks; // Chunks taken from the pool
+    size_t us_Groups; // Claims handed out of the chunks
+};
+
+
+/**
+ *  Claims of an evaluation, summed over the threads.
+ */
+
+struct ClaimReport {
+    size_t us_Chunks; // Atomic increments of the shared chunk cursor
+    size_t us_Groups; // Claims, one lockstep group each
+    size_t us_Contended; // Lock acquisitions which had to wait, the end of a rung
+};
 
 
 class TraderPool {
@@ -48,10 +100,16 @@ public:
 
     /**
      *  Reset the pool.
-     *  This also causes GetNextGenome() to return the first genome of the first species.
+     *  This also causes GetNextGenome() to return the first genome of the first species,
+     *  the genomes of all species are listed once here.
+     *  Genomes with a cached fitness get it at once and are left out of the race, so are
+     *  copies of a genome already in it, see SetFitnessCache().
+     *
+     *  \param b_FitnessCache False to evaluate every genome and keep the results out of
+     *                        the cache, e.g. on mini-batch windows.
      */
 
-    void Reset();
+    void Reset(bool b_FitnessCache = true);
 
     /**************************************************************************************
      * Update
@@ -75,13 +133,39 @@ public:
     cneat::genome *GetGenome(size_t us_Specie, size_t us_Genome) noexcept;
 
     /**
-     *  Get a pointer to the next genome.
+     *  Get a pointer to the next genome, without locking.
      *
      *  \return A cneat::genome object on success, NULL on failure.
      */
 
     cneat::genome *GetNextGenome() noexcept;
 
+    /**
+     *  Get pointers to the next genomes, without locking.
+     *
+     *  \param v_Genomes Receives the genomes, must hold at least us_Count pointers.
+     *  \param us_Count The maximum amount of genomes to claim.
+     *
+     *  \return The amount of genomes claimed, 0 if the pool is done.
+     */
+
+    size_t GetNextGenomes(std::vector<cneat::genome *> &v_Genomes, size_t us_Count) noexcept;
+
+    /**
+     *  Get pointers to the next race entries of the current rung, all of the same asset.
+     *  The entries are handed out in the order of SetScheduling(). A thread takes a chunk
+     *  of entries with one atomic increment, the claims are served from it without
+     *  locking, see SetClaiming().
+     *
+     *  \param s_Claim The chunk of the calling thread.
+     *  \param v_Entries Receives the entries, must hold at least us_Count pointers.
+     *  \param us_Count The maximum amount of entries to claim.
+     *
+     *  \return The amount of entries claimed, 0 if the rung is done.
+     */
+
+    size_t GetNextRaceEntries(RaceClaim &s_Claim, std::vector<RaceEntry *> &v_Entries, size_t us_Count) noexcept;
+
     /**
      *  Get the pools maximum fitness.
      *
@@ -158,8 +242,349 @@ public:
      */
     double GetBestGenomeFitness();
 
+    /**************************************************************************************
+     * Racing
+     **************************************************************************************/
+
+    /**
+     *  Set up successive halving. The dataset is split into us_Segments segments, every
+     *  rung evaluates the next one and only the best f64_Promotion of the genomes go on.
+     *
+     *  \param us_Segments Segments of the dataset, 1 == every genome sees all rows.
+     *  \param f64_Promotion Part of the genomes promoted to the next segment, at least one.
+     */
+
+    void SetRacing(size_t us_Segments, double f64_Promotion) noexcept;
+
+    /**
+     *  Get the rows of the current rung, without locking. The rung only changes between
+     *  evaluations.
+     *
+     *  \param us_Rows Rows of the dataset.
+     *  \param us_Begin Set to the first row.
+     *  \param us_End Set to one past the last row.
+     */
+
+    void GetRaceSegment(size_t us_Rows, size_t &us_Begin, size_t &us_End) noexcept;
+
+    /**
+     *  Finish the current rung. The fitness of the entries is written to their genomes,
+     *  see SetAssets(). The genomes still trading are ranked by the fitness of the
+     *  rows seen so far, the losers keep a conservative estimate of their full fitness:
+     *  losses are extrapolated to all rows, profits are not. Racing needs a single asset.
+     *
+     *  \param us_Rows Rows of the dataset.
+     *
+     *  \return True if the next rung has to be evaluated, false if the race is over.
+     */
+
+    bool NextRung(size_t us_Rows);
+
+    /**
+     *  Get the candle evaluations the losers of the race skipped since the last Reset().
+     *
+     *  \return Skipped rows, summed over the genomes.
+     */
+
+    size_t GetSkippedRows() noexcept;
+
+    /**************************************************************************************
+     * Scheduling
+     **************************************************************************************/
+
+    /**
+     *  Set the order the race entries are claimed in. Largest first sorts the entries of
+     *  every asset by their estimated cost, phenotype size times rows, so the small
+     *  genomes fill the gaps at the end of a rung. A claim then costs at most an average
+     *  claim, large genomes are claimed alone. The order does not change any fitness.
+     *
+     *  \param b_LargestFirst True == largest first, false == storage order.
+     */
+
+    void SetScheduling(bool b_LargestFirst) noexcept;
+
+    /**
+     *  Get the tail latency since the last Reset(), the time from the first thread
+     *  running out of entries to the last one finishing, summed over the rungs.
+     *
+     *  \return Tail latency in seconds.
+     */
+
+    double GetTailLatency() noexcept;
+
+    /**
+     *  Set the chunks the race entries of a rung are split into. Every chunk is at
+     *  least us_MinChunk entries of one asset and half of an even share of the work
+     *  still left after the chunks before it, so the chunks shrink towards the end of a
+     *  rung (guided scheduling).
+     *
+     *  \param us_Threads Threads evaluating the pool.
+     *  \param us_MinChunk Entries per chunk at least, e.g. the lockstep width.
+     */
+
+    void SetClaiming(size_t us_Threads, size_t us_MinChunk) noexcept;
+
+    /**
+     *  Add the claims of a thread.
+     *
+     *  \param s_Claim The chunk of the thread with its counters.
+     */
+
+    void AddClaimReport(const RaceClaim &s_Claim) noexcept;
+
+    /**
+     *  Get the summed claims since the last Reset().
+     *
+     *  \return Chunks, claims and contended locks.
+     */
+
+    ClaimReport GetClaimReport() noexcept;
+
+    /**************************************************************************************
+     * Workers
+     **************************************************************************************/
+
+    /**
+     *  Set the threads for the work around the evaluation: the fitness cache keys and
+     *  cost estimates of Reset() and the ranking of the species in NewGeneration(). The
+     *  results do not depend on the threads.
+     *
+     *  \param p_Workers The threads, NULL == the calling thread only. Has to outlive
+     *                   the pool or be unset first.
+     */
+
+    void SetWorkers(WorkerPool *p_Workers);
+
+    /**************************************************************************************
+     * Assets
+     **************************************************************************************/
+
+    /**
+     *  Set the datasets every genome is evaluated on. Reset() queues one race entry per
+     *  genome and asset, the longest asset first, so the entries of the short ones fill up
+     *  the threads at the end of an evaluation.
+     *
+     *  \param v_Rows Rows of every asset.
+     *  \param f_Aggregate Fitness of a genome from its fitness on every asset, empty == mean.
+     */
+
+    void SetAssets(const std::vector<size_t> &v_Rows, std::function<double(const std::vector<double> &)> f_Aggregate);
+
+    /**
+     *  Get the number of assets.
+     *
+     *  \return Datasets every genome is evaluated on.
+     */
+
+    size_t GetAssetCount() noexcept;
+
+    /**************************************************************************************
+     * Mini-batch
+     **************************************************************************************/
+
+    /**
+     *  Draw random windows of the dataset, evaluations use them until they are cleared.
+     *  All genomes of a generation see the same windows.
+     *
+     *  \param us_Rows Rows of the dataset.
+     *  \param us_Count Windows to draw.
+     *  \param us_Length Rows per window, all rows if the dataset is shorter.
+     */
+
+    void DrawWindows(size_t us_Rows, size_t us_Count, size_t us_Length);
+
+    /**
+     *  Clear the windows, evaluations use all rows again.
+     */
+
+    void ClearWindows() noexcept;
+
+    /**
+     *  Get the windows.
+     *
+     *  \return First and one past the last row of every window, empty == all rows.
+     */
+
+    std::vector<std::pair<size_t, size_t>> GetWindows();
+
+    /**
+     *  Set the fitness of the species champions, called when a generation is ranked.
+     *
+     *  \param f_Score Fitness of a champion, empty == the evaluated fitness.
+     */
+
+    void SetChampionScore(std::function<double(cneat::genome &)> f_Score);
+
+    /**
+     *  Set the function called with every genome that raises the maximum fitness.
+     *
+     *  \param f_NewBest Called with the genome and its generation during NewGeneration().
+     */
+
+    void SetNewBest(std::function<void(const cneat::genome &, unsigned int)> f_NewBest);
+
+    /**
+     *  Get the fitness of all genomes.
+     *
+     *  \return The fitness of every genome, species by species.
+     */
+
+    std::vector<double> GetFitness() noexcept;
+
+    /**
+     *  Spearman rank correlation, ties get their average rank.
+     *
+     *  \param v_A The first values.
+     *  \param v_B The second values, as many as v_A.
+     *
+     *  \return -1.0 to 1.0, 0.0 if a side is constant.
+     */
+
+    static double GetRankCorrelation(const std::vector<double> &v_A, const std::vector<double> &v_B);
+
+    /**************************************************************************************
+     * Phenotype optimization
+     **************************************************************************************/
+
+    /**
+     *  Add the optimization reports of evaluated genomes.
+     *
+     *  \param s_Report The summed reports.
+     */
+
+    void AddOptimizationReport(const cann::optimization_report &s_Report) noexcept;
+
+    /**
+     *  Get the summed optimization reports since the last Reset().
+     *
+     *  \return The summed reports.
+     */
+
+    cann::optimization_report GetOptimizationReport() noexcept;
+
+    /**************************************************************************************
+     * Phenotype cache
+     **************************************************************************************/
+
+    /**
+     *  Size the phenotype caches, once at setup. Built phenotypes of unchanged genomes are
+     *  kept across generations and shared by the evaluation threads.
+     *
+     *  \param us_Capacity Phenotypes kept per network type, 0 == off.
+     */
+
+    void SetPhenotypeCache(size_t us_Capacity);
+
+    /**
+     *  Get the phenotype cache of a network type.
+     *
+     *  \return The cache. Network is basic_feed_forward_network<T> or basic_recurrent_network<T>.
+     */
+
+    template<class Network>
+    cann::phenotype_cache<Network> &GetPhenotypeCache() noexcept;
+
+    /**
+     *  Add the phenotype cache lookups of evaluated genomes.
+     *
+     *  \param s_Report The summed hits, misses and evictions.
+     */
+
+    void AddCacheReport(const cann::cache_report &s_Report) noexcept;
+
+    /**
+     *  Get the summed phenotype cache lookups since the last Reset().
+     *
+     *  \return The summed lookups.
+     */
+
+    cann::cache_report GetCacheReport() noexcept;
+
+    /**************************************************************************************
+     * Fitness cache
+     **************************************************************************************/
+
+    /**
+     *  Keep the fitness of evaluated genomes for the rest of the run. The key is the hash
+     *  of the phenotype of a genome continued from ui_Seed, the seed has to identify the
+     *  datasets. The oldest entries are evicted above us_Capacity.
+     *
+     *  \param us_Capacity Genomes kept, 0 == off.
+     *  \param ui_Seed Hash of the datasets.
+     */
+
+    void SetFitnessCache(size_t us_Capacity, uint64_t ui_Seed);
+
+    /**
+     *  Get the fitness cache lookups since the last Reset(). A hit is a genome which was
+     *  not evaluated, a miss one which was.
+     *
+     *  \return Hits, misses and evictions.
+     */
+
+    cann::cache_report GetFitnessCacheReport() noexcept;
+
 private:
 
+    /**************************************************************************************
+     * Fitness
+     **************************************************************************************/
+
+    /**
+     *  Write the fitness of the race entries to their genomes, the lock has to be held.
+     */
+
+    void WriteFitness();
+
+    /**
+     *  Keep the final fitness of a race entry, the lock has to be held.
+     *
+     *  \param s_Entry The entry, its genome holds the fitness.
+     */
+
+    void CacheFitness(const RaceEntry &s_Entry);
+
+    /**
+     *  Cache the fitness of the remaining entries and copy it to the genomes left out as
+     *  copies, the lock has to be held. Called once the race is over.
+     */
+
+    void FinishRace();
+
+    /**
+     *  Set the claim order of the entries of the next rung, the lock has to be held.
+     */
+
+    void OrderRace();
+
+    /**
+     *  Split the claim order of the next rung into chunks, see SetClaiming(). The lock has
+     *  to be held.
+     */
+
+    void ChunkRace();
+
+    /**
+     *  Estimate the work of a genome per row, the enabled connections and the hidden and
+     *  output nodes on a path from an input to an output.
+     *
+     *  \param s_Genome The genome.
+     *
+     *  \return Connections and nodes.
+     */
+
+    static double GetPhenotypeSize(const cneat::genome &s_Genome);
+
+    /**
+     *  Call a function for every index, on the workers if set.
+     *
+     *  \param us_Count Indices.
+     *  \param us_Grain Indices per task.
+     *  \param f_Task Called with every index.
+     */
+
+    void ParallelFor(size_t us_Count, size_t us_Grain, const std::function<void(size_t)> &f_Task);
+
     /**************************************************************************************
      * Data
      **************************************************************************************/
@@ -171,10 +596,68 @@ private:
     //std::vector<cneat::specie>::iterator CurrentSpecie;
     //std::vector<cneat::genome>::iterator CurrentGenome;
 
-    size_t us_currentSpecie;
-    size_t us_currentGenome;
     size_t us_SpeciesSize;
 
+    // All genomes of the generation and the next one to hand out
+    std::vector<cneat::genome *> v_Population;
+    std::atomic<size_t> us_GenomeNext;
+
+    // Racing, entries of the current rung, the order they are claimed in and their estimated cost
+    std::vector<RaceEntry> v_Race;
+    std::vector<size_t> v_RaceOrder;
+    std::vector<double> v_RaceCost;
+    double f64_MeanCost;
+    size_t us_Rung;
+    size_t us_Segments;
+    double f64_Promotion;
+    size_t us_SkippedRows;
+
+    // Assets, longest first, their rows and the fitness of a genome on all of them
+    std::vector<size_t> v_AssetOrder;
+    std::vector<size_t> v_AssetRows;
+    std::function<double(const std::vector<double> &)> f_AssetFitness;
+
+    // Mini-batch windows of the current generation
+    std::vector<std::pair<size_t, size_t>> v_Windows;
+
+    // Summed optimize() results of the current evaluation
+    cann::optimization_report s_OptimizationReport;
+
+    // Built phenotypes per network type and the summed lookups of the current evaluation
+    cann::phenotype_cache<cann::basic_feed_forward_network<double>> s_FeedForwardCache;
+    cann::phenotype_cache<cann::basic_feed_forward_network<float>> s_FeedForwardCacheF;
+    cann::phenotype_cache<cann::basic_recurrent_network<double>> s_RecurrentCache;
+    cann::phenotype_cache<cann::basic_recurrent_network<float>> s_RecurrentCacheF;
+    cann::cache_report s_CacheReport;
+
+    // Fitness of evaluated genomes, oldest key first, and the lookups of the current evaluation
+    std::unordered_map<uint64_t, double> m_FitnessCache;
+    std::deque<uint64_t> v_FitnessOrder;
+    size_t us_FitnessCapacity;
+    uint64_t ui_FitnessSeed;
+    bool b_FitnessCache; // Used by the current evaluation
+    cann::cache_report s_FitnessReport;
+
+    // Genomes left out of the race as copies of an entry, and the genome they copy
+    std::vector<std::pair<cneat::genome *, cneat::genome *>> v_Copies;
+
+    // Scheduling, the first and the last claim which found no entry in the current rung
+    bool b_LargestFirst;
+    bool b_Idle;
+    std::chrono::steady_clock::time_point s_FirstIdle;
+    std::chrono::steady_clock::time_point s_LastIdle;
+    double f64_TailLatency;
+
+    // Claiming, the first position of every chunk of the rung and one past the last, the next chunk
+    std::vector<size_t> v_RaceChunks;
+    std::atomic<size_t> us_ChunkNext;
+    size_t us_ClaimThreads;
+    size_t us_MinChunk;
+    ClaimReport s_ClaimReport;
+
+    // Threads for tasks, NULL == none
+    WorkerPool *p_Workers;
+
     // Thread
     std::mutex s_Mutex;
 
@@ -182,4 +665,16 @@ protected:
 
 };
 
+template<>
+cann::phenotype_cache<cann::basic_feed_forward_network<double>> &TraderPool::GetPhenotypeCache() noexcept;
+
+template<>
+cann::phenotype_cache<cann::basic_feed_forward_network<float>> &TraderPool::GetPhenotypeCache() noexcept;
+
+template<>
+cann::phenotype_cache<cann::basic_recurrent_network<double>> &TraderPool::GetPhenotypeCache() noexcept;
+
+template<>
+cann::phenotype_cache<cann::basic_recurrent_network<float>> &TraderPool::GetPhenotypeCache() noexcept;
+
 #endif /* TraderPool_hpp */
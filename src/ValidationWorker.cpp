@@ -0,0 +1,151 @@
+//
+//  ValidationWorker.cpp
+//  CNT
+//
+
+// C / C++
+#include <fstream>
+
+// External
+
+// Project
+#include "./ValidationWorker.hpp"
+
+
+/**************************************************************************************
+ * Constructor / Destructor
+ * ------------------------
+ * Called on new and delete.
+ **************************************************************************************/
+
+ValidationWorker::ValidationWorker(const std::vector<std::string> &v_Paths, size_t us_Window,
+                                   std::function<double(cneat::genome &, const WindowView<double> &)> f_Score,
+                                   std::function<double(const std::vector<double> &)> f_Aggregate,
+                                   const std::string &s_LogPath) : v_Datasets(v_Paths.size()),
+                                                                   v_Candles(v_Paths.size()),
+                                                                   f_Score(f_Score),
+                                                                   f_Aggregate(f_Aggregate),
+                                                                   s_LogPath(s_LogPath),
+                                                                   ui_JobGeneration(0),
+                                                                   us_Dropped(0),
+                                                                   s_LastResult({0, 0.0, 0.0}),
+                                                                   b_HasResult(false),
+                                                                   b_Stop(false) {
+    // Load everything before the thread starts, it only reads
+    for (size_t i = 0; i < v_Paths.size(); i++) {
+        v_Datasets[i].Load(v_Paths[i]);
+        v_Candles[i] = v_Datasets[i].GetCandles<double>();
+        v_Data.push_back(WindowView<double>::Windows(v_Candles[i], v_Datasets[i].GetCandleSize(), us_Window,
+                                                     v_Datasets[i].GetClose<double>()));
+    }
+
+    std::ofstream fs_Log(s_LogPath, std::ios::app);
+    fs_Log << "generation,train,validate" << std::endl;
+
+    s_Thread = std::thread(&ValidationWorker::Run, this);
+}
+
+ValidationWorker::~ValidationWorker() noexcept {
+    Finish();
+}
+
+/**************************************************************************************
+ * Jobs
+ * ----
+ * Hand over genomes to the thread.
+ **************************************************************************************/
+
+void ValidationWorker::Finish() noexcept {
+    {
+        std::lock_guard<std::mutex> s_Guard(s_Mutex);
+        b_Stop = true;
+    }
+    s_Condition.notify_one();
+
+    if (s_Thread.joinable()) {
+        s_Thread.join();
+    }
+}
+
+void ValidationWorker::Submit(const cneat::genome &s_Genome, unsigned int ui_Generation) {
+    // Copy outside the lock, the evolution loop only waits for the swap
+    std::unique_ptr<cneat::genome> p_Genome(new cneat::genome(s_Genome));
+
+    {
+        std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+        if (b_Stop) {
+            return;
+        }
+
+        // A newer best genome makes the waiting one stale
+        if (p_Job) {
+            ++us_Dropped;
+        }
+
+        p_Job = std::move(p_Genome);
+        ui_JobGeneration = ui_Generation;
+    }
+    s_Condition.notify_one();
+}
+
+/**************************************************************************************
+ * Getters
+ * -------
+ * ValidationWorker getters.
+ **************************************************************************************/
+
+bool ValidationWorker::GetLastResult(ValidationResult &s_Result) {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    s_Result = s_LastResult;
+
+    return b_HasResult;
+}
+
+size_t ValidationWorker::GetDropped() {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    return us_Dropped;
+}
+
+/**************************************************************************************
+ * Thread
+ * ------
+ * Validate the latest job, the waiting job is finished before the thread ends.
+ **************************************************************************************/
+
+void ValidationWorker::Run() {
+    std::unique_ptr<cneat::genome> p_Genome;
+    unsigned int ui_Generation;
+    std::vector<double> v_Fitness(v_Data.size());
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> s_Lock(s_Mutex);
+            s_Condition.wait(s_Lock, [this] { return p_Job || b_Stop; });
+
+            if (!p_Job) {
+                return;
+            }
+
+            p_Genome = std::move(p_Job);
+            ui_Generation = ui_JobGeneration;
+        }
+
+        for (size_t i = 0; i < v_Data.size(); i++) {
+            v_Fitness[i] = f_Score(*p_Genome, v_Data[i]);
+        }
+
+        ValidationResult s_Result = {ui_Generation, p_Genome->fitness, f_Aggregate(v_Fitness)};
+
+        {
+            std::ofstream fs_Log(s_LogPath, std::ios::app);
+            fs_Log << s_Result.ui_Generation << "," << s_Result.f64_Train << "," << s_Result.f64_Validate << std::endl;
+        }
+
+        std::lock_guard<std::mutex> s_Guard(s_Mutex);
+        s_LastResult = s_Result;
+        b_HasResult = true;
+    }
+}
@@ -0,0 +1,155 @@
+//
+//  ValidationWorker.hpp
+//  CNT
+//
+
+#ifndef ValidationWorker_hpp
+#define ValidationWorker_hpp
+
+// C / C++
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+
+// External
+#include <cneat.h>
+
+// Project
+#include "./OHLCVDataset.hpp"
+#include "./WindowView.hpp"
+
+
+/**
+ *  Fitness of a best genome on the train and on the validation data.
+ */
+
+struct ValidationResult {
+    unsigned int ui_Generation;
+    double f64_Train;
+    double f64_Validate;
+};
+
+
+/**
+ *  Walk-forward validation of new best genomes in the background.
+ *  The worker owns its thread and its validation datasets. Submit() hands over a copy of
+ *  a genome and returns at once, a job still waiting when a newer best genome arrives is
+ *  dropped. Every result is appended to a CSV file of the session.
+ */
+
+class ValidationWorker {
+public:
+
+    /**************************************************************************************
+     * Constructor / Destructor
+     **************************************************************************************/
+
+    /**
+     *  Constructor, loads the datasets and starts the thread.
+     *
+     *  \param v_Paths The validation datasets, e.g. the *-validate.csv of every train set.
+     *  \param us_Window Previous candles in every row, as for the train data.
+     *  \param f_Score Fitness of a genome on one dataset.
+     *  \param f_Aggregate Fitness of a genome from its fitness on every dataset.
+     *  \param s_LogPath The CSV file the results are appended to.
+     */
+
+    ValidationWorker(const std::vector<std::string> &v_Paths, size_t us_Window,
+                     std::function<double(cneat::genome &, const WindowView<double> &)> f_Score,
+                     std::function<double(const std::vector<double> &)> f_Aggregate, const std::string &s_LogPath);
+
+    /**
+     *  Destructor, see Finish().
+     */
+
+    ~ValidationWorker() noexcept;
+
+    /**************************************************************************************
+     * Jobs
+     **************************************************************************************/
+
+    /**
+     *  Queue a genome for validation, replacing the waiting one.
+     *
+     *  \param s_Genome The genome, copied. Its fitness is the train fitness.
+     *  \param ui_Generation The generation it was found in.
+     */
+
+    void Submit(const cneat::genome &s_Genome, unsigned int ui_Generation);
+
+    /**
+     *  Finish the waiting job and join the thread, later jobs are ignored.
+     */
+
+    void Finish() noexcept;
+
+    /**************************************************************************************
+     * Getters
+     **************************************************************************************/
+
+    /**
+     *  Get the last result.
+     *
+     *  \param s_Result Set to the last result.
+     *
+     *  \return False if no genome was validated yet.
+     */
+
+    bool GetLastResult(ValidationResult &s_Result);
+
+    /**
+     *  Get the jobs dropped for a newer best genome.
+     *
+     *  \return Dropped jobs.
+     */
+
+    size_t GetDropped();
+
+private:
+
+    /**************************************************************************************
+     * Thread
+     **************************************************************************************/
+
+    /**
+     *  Validate jobs until the worker is destroyed.
+     */
+
+    void Run();
+
+    /**************************************************************************************
+     * Data
+     **************************************************************************************/
+
+    // Validation data, loaded once
+    std::vector<OHLCVDataset> v_Datasets;
+    std::vector<std::vector<double>> v_Candles;
+    std::vector<WindowView<double>> v_Data;
+
+    std::function<double(cneat::genome &, const WindowView<double> &)> f_Score;
+    std::function<double(const std::vector<double> &)> f_Aggregate;
+    std::string s_LogPath;
+
+    // The waiting job, empty == none
+    std::unique_ptr<cneat::genome> p_Job;
+    unsigned int ui_JobGeneration;
+    size_t us_Dropped;
+
+    ValidationResult s_LastResult;
+    bool b_HasResult;
+
+    // Thread, started last
+    std::mutex s_Mutex;
+    std::condition_variable s_Condition;
+    bool b_Stop;
+    std::thread s_Thread;
+
+protected:
+
+};
+
+#endif /* ValidationWorker_hpp */
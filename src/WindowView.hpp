@@ -0,0 +1,171 @@
+//
+//  WindowView.hpp
+//  CNT
+//
+
+#ifndef WindowView_hpp
+#define WindowView_hpp
+
+// C / C++
+#include <vector>
+#include <cstddef>
+
+// External
+
+// Project
+
+
+/**
+ *  Read only view of the input rows of a dataset, row i starts at p_First + i * i_Stride,
+ *  and of the close price of every row, a unit-stride column.
+ *  The view does not own the values, the buffers have to outlive it.
+ *
+ *  For a window of w candles the rows overlap: with the candles stored newest first,
+ *  candle i, i - 1, ..., i - w are back to back, so every row is a pointer into one
+ *  buffer of all candles and the stride is minus one candle. Memory scales with the
+ *  number of candles instead of candles * (w + 1).
+ *
+ *  T is the scalar type of the dataset, double or float.
+ */
+
+template<typename T>
+class WindowView {
+public:
+
+    /**************************************************************************************
+     * Constructor / Destructor
+     **************************************************************************************/
+
+    /**
+     *  Default constructor, an empty view.
+     */
+
+    WindowView() noexcept : p_First(nullptr), p_Close(nullptr), us_Rows(0), us_RowSize(0), i_Stride(0) {}
+
+    /**
+     *  Constructor.
+     *
+     *  \param p_First The first row.
+     *  \param us_Rows Number of rows.
+     *  \param us_RowSize Values per row.
+     *  \param i_Stride Distance between the starts of two rows, may be negative.
+     *  \param p_Close Close price of the first row, followed by the ones of the other rows.
+     */
+
+    WindowView(const T *p_First, size_t us_Rows, size_t us_RowSize, ptrdiff_t i_Stride, const T *p_Close) noexcept
+            : p_First(p_First), p_Close(p_Close), us_Rows(us_Rows), us_RowSize(us_RowSize), i_Stride(i_Stride) {}
+
+    /**
+     *  Windows over candles stored newest first.
+     *
+     *  \param v_Candles The candles, newest first, us_CandleSize values each.
+     *  \param us_CandleSize Values per candle.
+     *  \param us_Window Previous candles in every row.
+     *  \param p_Close The close prices of the candles, oldest first (see OHLCVDataset::GetClose()).
+     *
+     *  \return Row i holds candle i + us_Window of the series and the us_Window candles before it,
+     *          newest first. Empty if there are not enough candles.
+     */
+
+    static WindowView Windows(const std::vector<T> &v_Candles, size_t us_CandleSize, size_t us_Window,
+                              const T *p_Close) noexcept {
+        size_t us_Candles = us_CandleSize > 0 ? v_Candles.size() / us_CandleSize : 0;
+
+        if (us_Candles <= us_Window) {
+            return WindowView();
+        }
+
+        // The oldest row starts us_Window candles before the oldest candle
+        size_t us_Rows = us_Candles - us_Window;
+        return WindowView(v_Candles.data() + (us_Rows - 1) * us_CandleSize, us_Rows, us_CandleSize * (us_Window + 1),
+                          -static_cast<ptrdiff_t>(us_CandleSize), p_Close + us_Window);
+    }
+
+    /**
+     *  Rows stored back to back.
+     *
+     *  \param v_Rows The rows, us_RowSize values each.
+     *  \param us_RowSize Values per row.
+     *  \param p_Close The close price of every row.
+     *
+     *  \return Row i starts at i * us_RowSize.
+     */
+
+    static WindowView Rows(const std::vector<T> &v_Rows, size_t us_RowSize, const T *p_Close) noexcept {
+        return WindowView(v_Rows.data(), us_RowSize > 0 ? v_Rows.size() / us_RowSize : 0, us_RowSize,
+                          static_cast<ptrdiff_t>(us_RowSize), p_Close);
+    }
+
+    /**************************************************************************************
+     * Getters
+     **************************************************************************************/
+
+    /**
+     *  Get a row.
+     *
+     *  \param us_Row The row index.
+     *
+     *  \return Pointer to the us_RowSize values of the row.
+     */
+
+    const T *GetRow(size_t us_Row) const noexcept {
+        return p_First + static_cast<ptrdiff_t>(us_Row) * i_Stride;
+    }
+
+    /**
+     *  Get the close prices.
+     *
+     *  \return GetRows() values, the close price of row i at index i.
+     */
+
+    const T *GetClose() const noexcept {
+        return p_Close;
+    }
+
+    /**
+     *  Get the number of rows.
+     *
+     *  \return Rows of the view.
+     */
+
+    size_t GetRows() const noexcept {
+        return us_Rows;
+    }
+
+    /**
+     *  Get the values per row.
+     *
+     *  \return Values per row.
+     */
+
+    size_t GetRowSize() const noexcept {
+        return us_RowSize;
+    }
+
+    /**
+     *  Get the distance between two rows.
+     *
+     *  \return Values from the start of a row to the start of the next one.
+     */
+
+    ptrdiff_t GetStride() const noexcept {
+        return i_Stride;
+    }
+
+private:
+
+    /**************************************************************************************
+     * Data
+     **************************************************************************************/
+
+    const T *p_First;
+    const T *p_Close;
+    size_t us_Rows;
+    size_t us_RowSize;
+    ptrdiff_t i_Stride;
+
+protected:
+
+};
+
+#endif /* WindowView_hpp */
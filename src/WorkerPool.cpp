@@ -0,0 +1,386 @@
+//
+//  WorkerPool.cpp
+//  CNT
+//
+
+// C / C++
+#include <algorithm>
+
+// External
+
+// Project
+#include "./WorkerPool.hpp"
+
+
+// The pool and the worker of the calling thread, NULL outside of a pool
+static thread_local WorkerPool *p_CurrentPool = NULL;
+static thread_local size_t us_CurrentWorker = 0;
+
+
+/**************************************************************************************
+ * TaskGroup
+ * ---------
+ * Tasks waited for together.
+ **************************************************************************************/
+
+TaskGroup::TaskGroup(WorkerPool &s_Workers) noexcept : s_Workers(s_Workers),
+                                                       us_Pending(0) {}
+
+TaskGroup::~TaskGroup() noexcept {
+    Wait();
+}
+
+void TaskGroup::Run(std::function<void()> f_Task) {
+    if (s_Workers.v_Threads.empty()) {
+        f_Task();
+        return;
+    }
+
+    us_Pending.fetch_add(1);
+    s_Workers.Submit(new WorkerPool::Task{std::move(f_Task), this});
+}
+
+void TaskGroup::Wait() noexcept {
+    while (us_Pending.load() > 0) {
+        WorkerPool::Task *p_Task = s_Workers.FindTask();
+
+        if (p_Task) {
+            s_Workers.Execute(p_Task);
+            continue;
+        }
+
+        // Sleep until the group is done or there is a task to help with
+        std::unique_lock<std::mutex> s_Lock(s_Workers.s_Mutex);
+        s_Workers.i_Sleeping.fetch_add(1);
+        s_Workers.s_Wake.wait(s_Lock, [this] {
+            return us_Pending.load() == 0 || s_Workers.i_Queued.load() > 0;
+        });
+        s_Workers.i_Sleeping.fetch_sub(1);
+    }
+}
+
+/**************************************************************************************
+ * TaskDeque
+ * ---------
+ * Chase-Lev deque, see Le et al., Correct and Efficient Work-Stealing for Weak
+ * Memory Models, PPoPP 2013.
+ **************************************************************************************/
+
+WorkerPool::TaskDeque::TaskDeque() : i_Top(0),
+                                     i_Bottom(0),
+                                     v_Tasks(i_Capacity) {}
+
+bool WorkerPool::TaskDeque::Push(Task *p_Task) noexcept {
+    long i_B = i_Bottom.load(std::memory_order_relaxed);
+    long i_T = i_Top.load(std::memory_order_acquire);
+
+    if (i_B - i_T >= i_Capacity) {
+        return false;
+    }
+
+    // Publishes the task to the thieves, they load i_Bottom with acquire
+    v_Tasks[i_B & (i_Capacity - 1)].store(p_Task, std::memory_order_relaxed);
+    i_Bottom.store(i_B + 1, std::memory_order_release);
+
+    return true;
+}
+
+WorkerPool::Task *WorkerPool::TaskDeque::Pop() noexcept {
+    long i_B = i_Bottom.load(std::memory_order_relaxed) - 1;
+    i_Bottom.store(i_B, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long i_T = i_Top.load(std::memory_order_relaxed);
+
+    if (i_T > i_B) {
+        i_Bottom.store(i_B + 1, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    Task *p_Task = v_Tasks[i_B & (i_Capacity - 1)].load(std::memory_order_relaxed);
+
+    // The last task, race the thieves for it
+    if (i_T == i_B) {
+        if (!i_Top.compare_exchange_strong(i_T, i_T + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            p_Task = NULL;
+        }
+        i_Bottom.store(i_B + 1, std::memory_order_relaxed);
+    }
+
+    return p_Task;
+}
+
+WorkerPool::Task *WorkerPool::TaskDeque::Steal() noexcept {
+    long i_T = i_Top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long i_B = i_Bottom.load(std::memory_order_acquire);
+
+    if (i_T >= i_B) {
+        return NULL;
+    }
+
+    Task *p_Task = v_Tasks[i_T & (i_Capacity - 1)].load(std::memory_order_relaxed);
+    if (!i_Top.compare_exchange_strong(i_T, i_T + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return NULL;
+    }
+
+    return p_Task;
+}
+
+/**************************************************************************************
+ * Constructor / Destructor
+ * ------------------------
+ * Called on new and delete.
+ **************************************************************************************/
+
+WorkerPool::WorkerPool(unsigned int ui_Threads) : i_Queued(0),
+                                                  i_Sleeping(0),
+                                                  us_Wakes(0),
+                                                  f64_WakeSum(0.0),
+                                                  f64_WakeMax(0.0),
+                                                  b_Stop(false) {
+    for (unsigned int i = 0; i < ui_Threads; ++i) {
+        v_Workers.push_back(std::unique_ptr<Worker>(new Worker()));
+        v_Workers.back()->us_Tasks = 0;
+        v_Workers.back()->us_Steals = 0;
+    }
+
+    for (unsigned int i = 0; i < ui_Threads; ++i) {
+        v_Threads.push_back(std::thread(&WorkerPool::Work, this, i));
+    }
+}
+
+WorkerPool::~WorkerPool() noexcept {
+    Finish();
+}
+
+/**************************************************************************************
+ * Jobs
+ * ----
+ * Run a generation or a loop on all threads.
+ **************************************************************************************/
+
+void WorkerPool::Run(const std::function<void()> &f_Job) {
+    if (v_Threads.empty()) {
+        f_Job();
+        return;
+    }
+
+    TaskGroup s_Group(*this);
+    std::chrono::steady_clock::time_point s_RunStart = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < v_Threads.size(); ++i) {
+        s_Group.Run([this, &f_Job, s_RunStart]() {
+            // Only a worker waking up counts, not the caller helping out
+            if (p_CurrentPool == this) {
+                double f64_Wake = std::chrono::duration_cast<std::chrono::duration<double>>(
+                        std::chrono::steady_clock::now() - s_RunStart).count();
+
+                std::lock_guard<std::mutex> s_Guard(s_Mutex);
+                ++us_Wakes;
+                f64_WakeSum += f64_Wake;
+                f64_WakeMax = std::max(f64_WakeMax, f64_Wake);
+            }
+
+            f_Job();
+        });
+    }
+
+    // Work along, then help or sleep until the last worker is done
+    f_Job();
+    s_Group.Wait();
+}
+
+void WorkerPool::ParallelFor(size_t us_Begin, size_t us_End, size_t us_Grain,
+                             const std::function<void(size_t, size_t)> &f_Range) {
+    us_Grain = std::max<size_t>(us_Grain, 1);
+
+    if (us_Begin >= us_End) {
+        return;
+    }
+
+    if (v_Threads.empty() || us_End - us_Begin <= us_Grain) {
+        f_Range(us_Begin, us_End);
+        return;
+    }
+
+    TaskGroup s_Group(*this);
+    Split(s_Group, us_Begin, us_End, us_Grain, f_Range);
+    s_Group.Wait();
+}
+
+void WorkerPool::Finish() noexcept {
+    {
+        std::lock_guard<std::mutex> s_Guard(s_Mutex);
+        b_Stop = true;
+    }
+    s_Wake.notify_all();
+
+    for (size_t i = 0; i < v_Threads.size(); ++i) {
+        v_Threads[i].join();
+    }
+    v_Threads.clear();
+}
+
+/**************************************************************************************
+ * Getters
+ * -------
+ * WorkerPool getters.
+ **************************************************************************************/
+
+unsigned int WorkerPool::GetThreadCount() const noexcept {
+    return static_cast<unsigned int>(v_Threads.size());
+}
+
+WakeReport WorkerPool::GetWakeReport() {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    return {us_Wakes, us_Wakes > 0 ? f64_WakeSum / us_Wakes : 0.0, f64_WakeMax};
+}
+
+TaskReport WorkerPool::GetTaskReport() noexcept {
+    TaskReport s_Report = {0, 0};
+
+    for (auto &it_Worker : v_Workers) {
+        s_Report.us_Tasks += it_Worker->us_Tasks.load(std::memory_order_relaxed);
+        s_Report.us_Steals += it_Worker->us_Steals.load(std::memory_order_relaxed);
+    }
+
+    return s_Report;
+}
+
+/**************************************************************************************
+ * Setters
+ * -------
+ * WorkerPool setters.
+ **************************************************************************************/
+
+void WorkerPool::ResetWakeReport() {
+    std::lock_guard<std::mutex> s_Guard(s_Mutex);
+
+    us_Wakes = 0;
+    f64_WakeSum = 0.0;
+    f64_WakeMax = 0.0;
+}
+
+/**************************************************************************************
+ * Tasks
+ * -----
+ * Queue, find and run tasks.
+ **************************************************************************************/
+
+void WorkerPool::Submit(Task *p_Task) {
+    if (p_CurrentPool == this) {
+        // A full deque runs the task at once
+        if (!v_Workers[us_CurrentWorker]->s_Deque.Push(p_Task)) {
+            Execute(p_Task);
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> s_Guard(s_Mutex);
+        v_Shared.push_back(p_Task);
+    }
+
+    // A thief may count the task off first, i_Queued is only positive once it is queued.
+    // Pairs with the sleepers, they count themselves before checking i_Queued.
+    i_Queued.fetch_add(1);
+    if (i_Sleeping.load() > 0) {
+        std::lock_guard<std::mutex> s_Guard(s_Mutex);
+        s_Wake.notify_one();
+    }
+}
+
+WorkerPool::Task *WorkerPool::FindTask() noexcept {
+    Task *p_Task = NULL;
+    size_t us_Self = p_CurrentPool == this ? us_CurrentWorker : v_Workers.size();
+
+    if (us_Self < v_Workers.size()) {
+        p_Task = v_Workers[us_Self]->s_Deque.Pop();
+    }
+
+    if (!p_Task) {
+        std::lock_guard<std::mutex> s_Guard(s_Mutex);
+        if (!v_Shared.empty()) {
+            p_Task = v_Shared.front();
+            v_Shared.pop_front();
+        }
+    }
+
+    // Steal from the next workers first, the thieves spread over the deques
+    for (size_t i = 1; !p_Task && i <= v_Workers.size(); ++i) {
+        size_t us_Victim = (us_Self + i) % v_Workers.size();
+
+        if (us_Victim != us_Self) {
+            p_Task = v_Workers[us_Victim]->s_Deque.Steal();
+
+            if (p_Task && us_Self < v_Workers.size()) {
+                v_Workers[us_Self]->us_Steals.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    if (p_Task) {
+        i_Queued.fetch_sub(1);
+    }
+
+    return p_Task;
+}
+
+void WorkerPool::Execute(Task *p_Task) noexcept {
+    TaskGroup *p_Group = p_Task->p_Group;
+
+    p_Task->f_Run();
+    delete p_Task;
+
+    if (p_CurrentPool == this) {
+        v_Workers[us_CurrentWorker]->us_Tasks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The last task wakes the thread waiting for the group
+    if (p_Group->us_Pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> s_Guard(s_Mutex);
+        s_Wake.notify_all();
+    }
+}
+
+void WorkerPool::Split(TaskGroup &s_Group, size_t us_Begin, size_t us_End, size_t us_Grain,
+                       const std::function<void(size_t, size_t)> &f_Range) {
+    while (us_End - us_Begin > us_Grain) {
+        size_t us_Middle = us_Begin + (us_End - us_Begin) / 2;
+
+        s_Group.Run([this, &s_Group, us_Middle, us_End, us_Grain, &f_Range]() {
+            Split(s_Group, us_Middle, us_End, us_Grain, f_Range);
+        });
+        us_End = us_Middle;
+    }
+
+    f_Range(us_Begin, us_End);
+}
+
+/**************************************************************************************
+ * Thread
+ * ------
+ * Run tasks, sleep while there are none.
+ **************************************************************************************/
+
+void WorkerPool::Work(size_t us_Index) {
+    p_CurrentPool = this;
+    us_CurrentWorker = us_Index;
+
+    while (true) {
+        Task *p_Task = FindTask();
+
+        if (p_Task) {
+            Execute(p_Task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> s_Lock(s_Mutex);
+        i_Sleeping.fetch_add(1);
+        s_Wake.wait(s_Lock, [this] { return b_Stop || i_Queued.load() > 0; });
+        i_Sleeping.fetch_sub(1);
+
+        if (b_Stop && i_Queued.load() == 0) {
+            return;
+        }
+    }
+}
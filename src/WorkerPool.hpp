@@ -0,0 +1,354 @@
+//
+//  WorkerPool.hpp
+//  CNT
+//
+
+#ifndef WorkerPool_hpp
+#define WorkerPool_hpp
+
+// C / C++
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <chrono>
+
+// External
+
+// Project
+
+
+/**
+ *  Time from the start of a generation until a worker began on it.
+ */
+
+struct WakeReport {
+    size_t us_Wakes;
+    double f64_Mean;
+    double f64_Max;
+};
+
+
+/**
+ *  Tasks run by the workers and the ones they took from another thread.
+ */
+
+struct TaskReport {
+    size_t us_Tasks;
+    size_t us_Steals;
+};
+
+
+class WorkerPool;
+
+
+/**
+ *  Tasks which are waited for together. Wait() works on queued tasks of the pool until
+ *  every task of the group is done, the destructor waits as well.
+ */
+
+class TaskGroup {
+public:
+
+    /**************************************************************************************
+     * Constructor / Destructor
+     **************************************************************************************/
+
+    /**
+     *  Constructor.
+     *
+     *  \param s_Workers The pool running the tasks.
+     */
+
+    TaskGroup(WorkerPool &s_Workers) noexcept;
+
+    /**
+     *  Destructor, see Wait().
+     */
+
+    ~TaskGroup() noexcept;
+
+    /**************************************************************************************
+     * Tasks
+     **************************************************************************************/
+
+    /**
+     *  Queue a task, without worker threads it runs at once.
+     *
+     *  \param f_Task The task.
+     */
+
+    void Run(std::function<void()> f_Task);
+
+    /**
+     *  Block until every task of the group is done.
+     */
+
+    void Wait() noexcept;
+
+private:
+
+    friend class WorkerPool;
+
+    /**************************************************************************************
+     * Data
+     **************************************************************************************/
+
+    WorkerPool &s_Workers;
+    std::atomic<size_t> us_Pending;
+
+protected:
+
+};
+
+
+/**
+ *  Work-stealing worker threads. Every worker has a deque of tasks: it takes the newest of
+ *  its own tasks and steals the oldest of the others (Chase-Lev). Tasks queued by a
+ *  thread outside the pool go to a shared queue first. Idle workers sleep on a condition
+ *  variable with a predicate, a task queued before a worker started waiting is not lost.
+ *  The thread waiting for a TaskGroup helps with the queued tasks meanwhile.
+ */
+
+class WorkerPool {
+public:
+
+    /**************************************************************************************
+     * Constructor / Destructor
+     **************************************************************************************/
+
+    /**
+     *  Constructor, starts the threads.
+     *
+     *  \param ui_Threads Threads in addition to the calling thread, 0 == every task runs
+     *                    on the thread queueing it.
+     */
+
+    WorkerPool(unsigned int ui_Threads);
+
+    /**
+     *  Destructor, see Finish().
+     */
+
+    ~WorkerPool() noexcept;
+
+    /**************************************************************************************
+     * Jobs
+     **************************************************************************************/
+
+    /**
+     *  Run a job on every worker and the calling thread, block until all returned.
+     *
+     *  \param f_Job The job, e.g. claim and evaluate genomes until the pool has none left.
+     */
+
+    void Run(const std::function<void()> &f_Job);
+
+    /**
+     *  Call a function on ranges of indices, block until all returned. The range is split
+     *  in halves down to us_Grain indices, the halves are stolen by idle workers.
+     *
+     *  \param us_Begin First index.
+     *  \param us_End One past the last index.
+     *  \param us_Grain Indices per call at most, at least 1.
+     *  \param f_Range Called with the first and one past the last index of a range.
+     */
+
+    void ParallelFor(size_t us_Begin, size_t us_End, size_t us_Grain,
+                     const std::function<void(size_t, size_t)> &f_Range);
+
+    /**
+     *  Stop and join the threads, tasks run on the thread queueing them afterwards.
+     */
+
+    void Finish() noexcept;
+
+    /**************************************************************************************
+     * Getters
+     **************************************************************************************/
+
+    /**
+     *  Get the worker threads.
+     *
+     *  \return Threads in addition to the calling thread.
+     */
+
+    unsigned int GetThreadCount() const noexcept;
+
+    /**
+     *  Get the wake-up latency of the workers since the last ResetWakeReport().
+     *
+     *  \return Wake-ups and their mean and maximum latency in seconds.
+     */
+
+    WakeReport GetWakeReport();
+
+    /**
+     *  Get the tasks the workers ran since they started.
+     *
+     *  \return Tasks run and stolen.
+     */
+
+    TaskReport GetTaskReport() noexcept;
+
+    /**************************************************************************************
+     * Setters
+     **************************************************************************************/
+
+    /**
+     *  Start a new wake-up latency measurement.
+     */
+
+    void ResetWakeReport();
+
+private:
+
+    friend class TaskGroup;
+
+    /**
+     *  A queued task and the group waiting for it.
+     */
+
+    struct Task {
+        std::function<void()> f_Run;
+        TaskGroup *p_Group;
+    };
+
+    /**
+     *  Fixed size Chase-Lev deque. Only the owning worker pushes and pops at the bottom,
+     *  any thread steals at the top.
+     */
+
+    class TaskDeque {
+    public:
+
+        TaskDeque();
+
+        /**
+         *  Push a task, owner only.
+         *
+         *  \return False if the deque is full.
+         */
+
+        bool Push(Task *p_Task) noexcept;
+
+        /**
+         *  Pop the newest task, owner only.
+         *
+         *  \return The task, NULL if empty.
+         */
+
+        Task *Pop() noexcept;
+
+        /**
+         *  Steal the oldest task.
+         *
+         *  \return The task, NULL if empty or lost to another thread.
+         */
+
+        Task *Steal() noexcept;
+
+    private:
+
+        static const long i_Capacity = 4096; // Power of 2
+
+        std::atomic<long> i_Top;
+        std::atomic<long> i_Bottom;
+        std::vector<std::atomic<Task *>> v_Tasks;
+    };
+
+    /**
+     *  A worker, its deque and its counters.
+     */
+
+    struct Worker {
+        TaskDeque s_Deque;
+        std::atomic<size_t> us_Tasks;
+        std::atomic<size_t> us_Steals;
+    };
+
+    /**************************************************************************************
+     * Tasks
+     **************************************************************************************/
+
+    /**
+     *  Queue a task, on the deque of the calling worker or the shared queue.
+     *
+     *  \param p_Task The task, deleted once it ran.
+     */
+
+    void Submit(Task *p_Task);
+
+    /**
+     *  Take a task: the own newest one, a shared one or the oldest one of another worker.
+     *
+     *  \return The task, NULL if none was found.
+     */
+
+    Task *FindTask() noexcept;
+
+    /**
+     *  Run a task and finish it for its group.
+     *
+     *  \param p_Task The task, deleted afterwards.
+     */
+
+    void Execute(Task *p_Task) noexcept;
+
+    /**
+     *  Queue the upper halves of a range and call the function on the rest.
+     *
+     *  \param s_Group The group of the tasks.
+     *  \param us_Begin First index.
+     *  \param us_End One past the last index.
+     *  \param us_Grain Indices per call at most.
+     *  \param f_Range Called with every range.
+     */
+
+    void Split(TaskGroup &s_Group, size_t us_Begin, size_t us_End, size_t us_Grain,
+               const std::function<void(size_t, size_t)> &f_Range);
+
+    /**************************************************************************************
+     * Thread
+     **************************************************************************************/
+
+    /**
+     *  Run tasks until the pool is finished.
+     *
+     *  \param us_Index The worker of the thread.
+     */
+
+    void Work(size_t us_Index);
+
+    /**************************************************************************************
+     * Data
+     **************************************************************************************/
+
+    // Workers, one per thread, and the tasks of threads outside the pool
+    std::vector<std::unique_ptr<Worker>> v_Workers;
+    std::deque<Task *> v_Shared;
+
+    // Tasks queued but not taken, threads sleeping until there are some
+    std::atomic<long> i_Queued;
+    std::atomic<long> i_Sleeping;
+
+    // Wake-up latency
+    size_t us_Wakes;
+    double f64_WakeSum;
+    double f64_WakeMax;
+
+    // Threads, started last
+    std::mutex s_Mutex;
+    std::condition_variable s_Wake;
+    bool b_Stop;
+    std::vector<std::thread> v_Threads;
+
+protected:
+
+};
+
+#endif /* WorkerPool_hpp */
@@ -4,10 +4,19 @@
 
 #include "cann.h"
 
+
+// Timesteps per sweep of activate_batch
+static const size_t us_BatchBlock = 128;
+
+// Last opcode of every bytecode program, see cann::instruction
+static const unsigned int ui_OpEnd = 9;
+
+
 /****************************************************
  * Constructor
  ****************************************************/
-cann::feed_forward_network::feed_forward_network()
+template<typename T>
+cann::basic_feed_forward_network<T>::basic_feed_forward_network()
 {
 
 }
@@ -22,7 +31,8 @@ cann::feed_forward_network::feed_forward_network()
  * @return
  *
  ****************************************************/
-std::vector<cneat::node_gene>::iterator cann::feed_forward_network::find_node(std::vector<cneat::node_gene> &nodes, int key) {
+template<typename T>
+std::vector<cneat::node_gene>::iterator cann::basic_feed_forward_network<T>::find_node(std::vector<cneat::node_gene> &nodes, int key) {
 
     for (auto node = nodes.begin(); node != nodes.end(); node++)
     {
@@ -40,9 +50,58 @@ std::vector<cneat::node_gene>::iterator cann::feed_forward_network::find_node(st
  * Creation of the network
  **************************************************************************************/
 
+namespace {
+
+    /****************************************************
+     *
+     * Adjacency index over a connection list.
+     * Maps every node key to a dense id and stores the indices of the
+     * incoming and outgoing connections of each node in connection order.
+     *
+     ****************************************************/
+    struct connection_index {
+
+        std::unordered_map<int, size_t> ids;
+        std::vector<int> keys;
+        std::vector<std::vector<size_t>> incoming;
+        std::vector<std::vector<size_t>> outgoing;
+
+        explicit connection_index(std::vector<cneat::connection_gene> &connections)
+        {
+            for (size_t us_conn = 0; us_conn < connections.size(); us_conn++)
+            {
+                size_t us_from = id(connections[us_conn].from_node);
+                size_t us_to = id(static_cast<int>(connections[us_conn].to_node));
+
+                outgoing[us_from].push_back(us_conn);
+                incoming[us_to].push_back(us_conn);
+            }
+        }
+
+        size_t id(int key)
+        {
+            auto it_id = ids.find(key);
+            if (it_id != ids.end())
+            {
+                return it_id->second;
+            }
+
+            size_t us_id = keys.size();
+            ids.emplace(key, us_id);
+            keys.push_back(key);
+            incoming.emplace_back();
+            outgoing.emplace_back();
+
+            return us_id;
+        }
+    };
+
+} // End of anonymous namespace
+
 /****************************************************
  *
  * Collect the nodes whose state is required to compute the final network output(s).
+ * Reverse breadth first search from the outputs, every connection is visited once.
  *
  * @brief neuralnet::required_for_output
  * @param input
@@ -51,72 +110,98 @@ std::vector<cneat::node_gene>::iterator cann::feed_forward_network::find_node(st
  * @return
  *
  ****************************************************/
-std::vector<int> cann::feed_forward_network::required_for_output(std::vector<int> &input, std::vector<int> &output, std::vector<cneat::connection_gene> &connections)
+template<typename T>
+std::vector<int> cann::basic_feed_forward_network<T>::required_for_output(std::vector<int> &input, std::vector<int> &output, std::vector<cneat::connection_gene> &connections)
 {
+    connection_index index(connections);
     std::vector<int> required;
-    std::vector<int> s;
 
-    for (auto i = output.begin(); i != output.end(); i++)
+    std::vector<size_t> frontier;
+    for (auto it_output : output)
     {
-        if(std::find(s.begin(), s.end(), *i) == s.end())
+        frontier.push_back(index.id(it_output));
+    }
+    for (auto it_input : input)
+    {
+        index.id(it_input);
+    }
+
+    std::vector<bool> b_inS(index.keys.size(), false);
+    std::vector<bool> b_required(index.keys.size(), false);
+    std::vector<bool> b_input(index.keys.size(), false);
+
+    for (auto it_input : input)
+    {
+        b_input[index.id(it_input)] = true;
+    }
+
+    // s and required start with the outputs
+    size_t us_frontier = 0;
+    for (auto it_id : frontier)
+    {
+        if (!b_inS[it_id])
         {
-            s.push_back((*i));
+            b_inS[it_id] = true;
+            frontier[us_frontier++] = it_id;
         }
-        if(std::find(required.begin(), required.end(), *i) == required.end())
+        if (!b_required[it_id])
         {
-            required.push_back(*i);
+            b_required[it_id] = true;
+            required.push_back(index.keys[it_id]);
         }
     }
+    frontier.resize(us_frontier);
 
+    std::vector<size_t> edges;
+    std::vector<size_t> t;
     while (true)
     {
-        // Find nodes not in S whose output is consumed by a node in s
-        std::vector<int> t;
-        for (auto i = connections.begin(); i != connections.end(); i++)
+        // Find nodes not in s whose output is consumed by a node in s.
+        // Only the nodes added last can have such producers, keep connection order.
+        edges.clear();
+        for (auto it_id : frontier)
         {
-            if (std::find(s.begin(), s.end(), i->from_node) == s.end() && std::find(s.begin(), s.end(), i->to_node) != s.end() && std::find(t.begin(), t.end(), i->from_node) == t.end() )
-            {
-                t.push_back(i->from_node);
-            }
+            edges.insert(edges.end(), index.incoming[it_id].begin(), index.incoming[it_id].end());
         }
+        std::sort(edges.begin(), edges.end());
 
-        if (t.empty())
-        {
-            break;
-        }
-
-        std::vector<int> layer_nodes;
-        for (auto i = t.begin(); i != t.end(); i++)
+        t.clear();
+        for (auto it_edge : edges)
         {
-            if (std::find(input.begin(), input.end(), *i) == input.end() && std::find(layer_nodes.begin(), layer_nodes.end(), *i) == layer_nodes.end())
+            size_t us_from = index.ids.find(connections[it_edge].from_node)->second;
+            if (!b_inS[us_from])
             {
-                layer_nodes.push_back((*i));
+                b_inS[us_from] = true;
+                t.push_back(us_from);
             }
         }
 
-        if (layer_nodes.empty())
+        if (t.empty())
         {
             break;
         }
 
-        // add to required and s
-        for(auto layer_node : layer_nodes)
+        // add non input nodes to required
+        bool b_layerEmpty = true;
+        for (auto it_id : t)
         {
-            if(std::find(required.begin(), required.end(), layer_node) == required.end())
+            if (!b_input[it_id])
             {
-                required.push_back(layer_node);
+                b_layerEmpty = false;
+                if (!b_required[it_id])
+                {
+                    b_required[it_id] = true;
+                    required.push_back(index.keys[it_id]);
+                }
             }
         }
-        for(auto it_t : t)
+
+        if (b_layerEmpty)
         {
-            if(std::find(s.begin(), s.end(), it_t) == s.end())
-            {
-                s.push_back(it_t);
-            }
+            break;
         }
 
-        //required.insert(required.end(), layer_nodes.begin(), layer_nodes.end());
-        //s.insert(s.end(), t.begin(), t.end());
+        frontier.swap(t);
     }
 
     return required;
@@ -129,57 +214,70 @@ std::vector<int> cann::feed_forward_network::required_for_output(std::vector<int
  * Note that the returned layers do not contain nodes whose output is ultimately
  * never used to compute the final network output.
  *
+ * Kahn's algorithm over the required nodes. A node joins the layer after its last
+ * producer, inside a layer the nodes are ordered by their first incoming connection.
+ *
  * @brief feed_forward_network::feed_forward_layers
  * @param input
  * @param output
  * @param connections
  *
  ****************************************************/
-std::vector<std::vector<int>> cann::feed_forward_network::feed_forward_layers(std::vector<int> &input, std::vector<int> &output,
+template<typename T>
+std::vector<std::vector<int>> cann::basic_feed_forward_network<T>::feed_forward_layers(std::vector<int> &input, std::vector<int> &output,
                                           std::vector<cneat::connection_gene> &connections)
 {
     std::vector<int> required = this->required_for_output(input, output, connections);
     std::vector<std::vector<int>> layers;
-    std::vector<int> s;
 
-    // append inputs to s
-    for (auto i : input)
+    connection_index index(connections);
+    for (auto it_input : input)
     {
-        s.push_back(i);
+        index.id(it_input);
     }
 
-    while (true)
+    std::vector<bool> b_required(index.keys.size(), false);
+    for (auto it_required : required)
     {
-        std::vector<unsigned int> c;
-        for (auto it_conn : connections)
+        auto it_id = index.ids.find(it_required);
+        if (it_id != index.ids.end())
         {
-            if (std::find(s.begin(), s.end(), it_conn.from_node) != s.end()
-                && std::find(s.begin(), s.end(), it_conn.to_node) == s.end()
-                && std::find(c.begin(), c.end(), it_conn.to_node) == c.end())
-            {
-                c.push_back(it_conn.to_node);
-            }
+            b_required[it_id->second] = true;
         }
+    }
 
+    // Producers of each node which are not in s yet
+    std::vector<size_t> remaining(index.keys.size());
+    for (size_t us_id = 0; us_id < index.keys.size(); us_id++)
+    {
+        remaining[us_id] = index.incoming[us_id].size();
+    }
 
-        std::vector<int> t;
-        for (auto it_c : c)
+    // s starts with the inputs
+    std::vector<bool> b_inS(index.keys.size(), false);
+    std::vector<size_t> frontier;
+    for (auto it_input : input)
+    {
+        size_t us_id = index.id(it_input);
+        if (!b_inS[us_id])
         {
-            std::vector<bool> vec_all;
-            for (auto it_conn : connections)
-            {
-                if (it_conn.to_node == it_c)
-                {
-                    vec_all.push_back(std::find(s.begin(), s.end(), it_conn.from_node) != s.end());
-                }
-            }
-
-            if (std::find(required.begin(), required.end(), it_c) != required.end()
-                && std::find(vec_all.begin(), vec_all.end(), false) == vec_all.end()) {
+            b_inS[us_id] = true;
+            frontier.push_back(us_id);
+        }
+    }
 
-                if (std::find(t.begin(), t.end(), it_c) == t.end())
+    std::vector<size_t> t;
+    while (true)
+    {
+        t.clear();
+        for (auto it_id : frontier)
+        {
+            for (auto it_edge : index.outgoing[it_id])
+            {
+                size_t us_to = index.ids.find(static_cast<int>(connections[it_edge].to_node))->second;
+                if (--remaining[us_to] == 0 && b_required[us_to] && !b_inS[us_to])
                 {
-                    t.push_back(it_c);
+                    t.push_back(us_to);
                 }
             }
         }
@@ -189,20 +287,23 @@ std::vector<std::vector<int>> cann::feed_forward_network::feed_forward_layers(st
             break;
         }
 
-        layers.push_back(t);
-        for(auto it_t : t)
+        std::sort(t.begin(), t.end(), [&index](size_t a, size_t b) {
+            return index.incoming[a].front() < index.incoming[b].front();
+        });
+
+        std::vector<int> layer;
+        layer.reserve(t.size());
+        for (auto it_id : t)
         {
-            if(std::find(s.begin(), s.end(), it_t) == s.end())
-            {
-                s.push_back(it_t);
-            }
+            b_inS[it_id] = true;
+            layer.push_back(index.keys[it_id]);
         }
-        // s.insert(s.end(), t.begin(), t.end());
-    }
 
+        layers.push_back(layer);
+        frontier.swap(t);
+    }
 
     return layers;
-
 }
 
 
@@ -214,7 +315,8 @@ std::vector<std::vector<int>> cann::feed_forward_network::feed_forward_layers(st
  * @param g
  *
  ****************************************************/
-void cann::feed_forward_network::from_genome(cneat::genome &g)
+template<typename T>
+void cann::basic_feed_forward_network<T>::from_genome(cneat::genome &g)
 {
     if (g.can_be_recurrent)
     {
@@ -237,40 +339,48 @@ void cann::feed_forward_network::from_genome(cneat::genome &g)
     this->input_keys = g.input_pins;
     this->output_keys = g.output_pins;
 
-    // Gather expressed connections
-    std::vector<cneat::connection_gene> connections;
-    for (auto it_connection : g.connection_genes)
+    // Gather expressed connections, grouped by their target node
+    std::unordered_map<int, std::vector<std::pair<int, double>>> node_inputs;
+    for (auto &it_connection : g.connection_genes)
     {
         if (it_connection.enabled)
         {
-            connections.push_back((it_connection));
+            node_inputs[static_cast<int>(it_connection.to_node)].push_back(
+                    std::make_pair(it_connection.from_node, it_connection.weight));
         }
     }
 
+    // Index node genes by key, the first gene with a key wins
+    std::unordered_map<int, size_t> node_index;
+    for (size_t us_node = 0; us_node < g.node_genes.size(); us_node++)
+    {
+        node_index.emplace(static_cast<int>(g.node_genes[us_node].key), us_node);
+    }
+
     std::vector<std::vector<int>> layers = this->feed_forward_layers(g.input_pins, g.output_pins,g.connection_genes);
 
-    for (auto layer : layers)
+    for (auto &layer : layers)
     {
         for (auto node : layer)
         {
-            neuron new_neuron;
-            for (auto conn : connections)
+            auto it_node = node_index.find(node);
+
+            if (it_node != node_index.end())
             {
-                if (conn.to_node == node)
+                cneat::node_gene &node_gene = g.node_genes[it_node->second];
+
+                neuron new_neuron;
+                auto it_inputs = node_inputs.find(node);
+                if (it_inputs != node_inputs.end())
                 {
-                    new_neuron.inputs.push_back(std::make_pair(conn.from_node, conn.weight));
+                    new_neuron.inputs = it_inputs->second;
                 }
 
-            }
-            auto it_node = this->find_node(g.node_genes, node);
-
-            if (it_node != g.node_genes.end())
-            {
-                new_neuron.activation_function = it_node->activation_function;
-                new_neuron.aggregation_function = it_node->aggregation_function;
-                new_neuron.bias = it_node->bias;
-                new_neuron.response = it_node->response;
-                new_neuron.node = it_node->key;
+                new_neuron.activation_function = node_gene.activation_function;
+                new_neuron.aggregation_function = node_gene.aggregation_function;
+                new_neuron.bias = node_gene.bias;
+                new_neuron.response = node_gene.response;
+                new_neuron.node = node_gene.key;
 
                 // Add to node_eval vector
                 node_evals.push_back(new_neuron);
@@ -282,19 +392,335 @@ void cann::feed_forward_network::from_genome(cneat::genome &g)
     input_keys = g.input_pins;
     output_keys = g.output_pins;
 
-    // pre-populate values
+    // Flatten node_evals for activate()
+    this->compile();
+}
+
+
+/****************************************************
+ *
+ * Remap the node keys of node_evals to dense slots and
+ * store all incoming links in one contiguous array.
+ * Inputs occupy the first slots, followed by the outputs,
+ * so activate() never has to hash a node key.
+ *
+ * @brief feed_forward_network::compile
+ *
+ ****************************************************/
+template<typename T>
+void cann::basic_feed_forward_network<T>::compile()
+{
+    this->output_slots.clear();
+    this->neurons.clear();
+    this->links.clear();
+    this->program.clear();
+    this->batch_inputs.clear();
+    this->values.clear();
+    this->batch_values.clear();
+
+    std::unordered_map<int, unsigned int> slots;
+    auto get_slot = [&slots](int key) -> unsigned int {
+        auto it_slot = slots.find(key);
+        if (it_slot != slots.end())
+        {
+            return it_slot->second;
+        }
+
+        unsigned int slot = static_cast<unsigned int>(slots.size());
+        slots.emplace(key, slot);
+        return slot;
+    };
+
     for (auto input : input_keys)
     {
-        values[input] = 0.0;
+        get_slot(input);
+    }
+
+    for (auto output : output_keys)
+    {
+        output_slots.push_back(get_slot(output));
+    }
+
+    size_t us_linkCount = 0;
+    for (auto &it_neuron : node_evals)
+    {
+        us_linkCount += it_neuron.inputs.size();
+    }
+
+    this->neurons.reserve(node_evals.size());
+    this->links.reserve(us_linkCount);
+
+    for (auto &it_neuron : node_evals)
+    {
+        compiled_neuron new_neuron;
+        new_neuron.slot = get_slot(it_neuron.node);
+        new_neuron.aggregation_function = it_neuron.aggregation_function;
+        new_neuron.activation_function = it_neuron.activation_function;
+        new_neuron.response = static_cast<T>(it_neuron.response);
+        new_neuron.bias = static_cast<T>(it_neuron.bias);
+        new_neuron.first_link = static_cast<unsigned int>(links.size());
+
+        // Sources which are never evaluated get their own slot and stay 0.0
+        for (auto &it_input : it_neuron.inputs)
+        {
+            link new_link;
+            new_link.slot = get_slot(it_input.first);
+            new_link.weight = static_cast<T>(it_input.second);
+            this->links.push_back(new_link);
+        }
+
+        new_neuron.last_link = static_cast<unsigned int>(links.size());
+        this->neurons.push_back(new_neuron);
+    }
+
+    this->values.assign(slots.size(), 0.0);
+
+    // Bytecode, unknown functions fall back to sum and sigmoid like the switches in activate()
+    this->program.reserve(neurons.size() + 1);
+    for (auto &it_neuron : neurons)
+    {
+        unsigned int ui_agg = it_neuron.aggregation_function == 1 || it_neuron.aggregation_function == 2 ?
+                              static_cast<unsigned int>(it_neuron.aggregation_function) : 0;
+        unsigned int ui_act = it_neuron.activation_function == 1 || it_neuron.activation_function == 2 ?
+                              static_cast<unsigned int>(it_neuron.activation_function) : 0;
+
+        instruction new_instruction;
+        new_instruction.opcode = ui_agg * 3 + ui_act;
+        new_instruction.slot = it_neuron.slot;
+        new_instruction.first_link = it_neuron.first_link;
+        new_instruction.last_link = it_neuron.last_link;
+        new_instruction.response = it_neuron.response;
+        new_instruction.bias = it_neuron.bias;
+        this->program.push_back(new_instruction);
+    }
+
+    instruction end_instruction = {ui_OpEnd, 0, 0, 0, 0.0, 0.0};
+    this->program.push_back(end_instruction);
+
+    // Input slots which are actually read, so activate_batch only transposes those
+    std::vector<bool> b_used(input_keys.size(), false);
+    for (auto &it_link : links)
+    {
+        if (it_link.slot < input_keys.size())
+        {
+            b_used[it_link.slot] = true;
+        }
+    }
+    for (unsigned int ui_slot = 0; ui_slot < b_used.size(); ui_slot++)
+    {
+        if (b_used[ui_slot])
+        {
+            this->batch_inputs.push_back(ui_slot);
+        }
+    }
+}
+
+namespace {
+
+    /****************************************************
+     * Activation in double, for values folded by optimize()
+     ****************************************************/
+    double activation(int activation_function, double in)
+    {
+        switch (activation_function)
+        {
+            case 1:
+                return std::tanh(in);
+
+            case 2:
+                return std::sin(in);
+
+            default:
+                return 1 / (1 + std::exp(-1 * in));
+        }
+    }
+
+} // End of anonymous namespace
+
+/****************************************************
+ *
+ * Forward over node_evals: mean becomes sum with weights
+ * divided by the link count, duplicate links are merged,
+ * constant sources are moved into the bias. A node left
+ * without links is the constant act(bias). PRODUCT nodes
+ * are constant too, agg_prod() starts at 0.0.
+ * Backward from the outputs: drop nodes nobody reads.
+ *
+ * Mean nodes without links evaluate to NaN and are kept
+ * as they are, as is everything downstream of them.
+ *
+ * @brief feed_forward_network::optimize
+ * @param prune_weight
+ * @return Node and link counts before and after
+ *
+ ****************************************************/
+template<typename T>
+cann::optimization_report cann::basic_feed_forward_network<T>::optimize(double prune_weight)
+{
+    optimization_report report = {0, 0, 0, 0, 0, 0};
+    report.nodes_before = node_evals.size();
+    for (auto &it_neuron : node_evals)
+    {
+        report.links_before += it_neuron.inputs.size();
+    }
+
+    std::unordered_map<int, double> constants;
+    std::unordered_map<int, bool> b_evaluated;
+    std::unordered_map<int, bool> b_nonFinite;
+    for (auto input : input_keys)
+    {
+        b_evaluated[input] = true;
+    }
+
+    for (auto &it_neuron : node_evals)
+    {
+        bool b_nan = it_neuron.aggregation_function == 2 && it_neuron.inputs.empty();
+        for (auto &it_input : it_neuron.inputs)
+        {
+            b_nan = b_nan || b_nonFinite.count(it_input.first) > 0;
+        }
+
+        if (b_nan)
+        {
+            b_nonFinite[it_neuron.node] = true;
+            b_evaluated[it_neuron.node] = true;
+            continue;
+        }
+
+        if (it_neuron.aggregation_function == 1)
+        {
+            it_neuron.inputs.clear();
+        } else if (it_neuron.aggregation_function == 2) {
+
+            double f64_count = static_cast<double>(it_neuron.inputs.size());
+            for (auto &it_input : it_neuron.inputs)
+            {
+                it_input.second = it_input.second / f64_count;
+            }
+        }
+        it_neuron.aggregation_function = 0;
+
+        // Merge duplicates, keep the first occurrence
+        std::unordered_map<int, size_t> link_index;
+        std::vector<std::pair<int, double>> inputs;
+        for (auto &it_input : it_neuron.inputs)
+        {
+            auto it_index = link_index.find(it_input.first);
+            if (it_index != link_index.end())
+            {
+                inputs[it_index->second].second += it_input.second;
+                ++report.links_merged;
+            } else {
+
+                link_index.emplace(it_input.first, inputs.size());
+                inputs.push_back(it_input);
+            }
+        }
+
+        // Fold constant sources, drop sources which are never evaluated and pruned weights
+        double f64_constant = 0.0;
+        it_neuron.inputs.clear();
+        for (auto &it_input : inputs)
+        {
+            auto it_constant = constants.find(it_input.first);
+            if (it_constant != constants.end())
+            {
+                f64_constant += it_constant->second * it_input.second;
+            } else if (b_evaluated.count(it_input.first) > 0 && std::fabs(it_input.second) > prune_weight) {
+                it_neuron.inputs.push_back(it_input);
+            }
+        }
+        it_neuron.bias += f64_constant * it_neuron.response;
+
+        if (it_neuron.inputs.empty())
+        {
+            constants[it_neuron.node] = activation(it_neuron.activation_function, 0.0 * it_neuron.response + it_neuron.bias);
+            ++report.constants_folded;
+        }
+
+        b_evaluated[it_neuron.node] = true;
     }
 
+    // Only keep what the outputs read
+    std::unordered_map<int, bool> b_needed;
     for (auto output : output_keys)
     {
-        values[output] = 0.0;
+        b_needed[output] = true;
+    }
+
+    std::vector<neuron> kept;
+    for (auto it_neuron = node_evals.rbegin(); it_neuron != node_evals.rend(); ++it_neuron)
+    {
+        if (b_needed.count(it_neuron->node) > 0)
+        {
+            for (auto &it_input : it_neuron->inputs)
+            {
+                b_needed[it_input.first] = true;
+            }
+            kept.push_back(*it_neuron);
+        }
+    }
+    this->node_evals.assign(kept.rbegin(), kept.rend());
+
+    report.nodes_after = node_evals.size();
+    for (auto &it_neuron : node_evals)
+    {
+        report.links_after += it_neuron.inputs.size();
+    }
+
+    this->compile();
+    return report;
+}
+
+/****************************************************
+ *
+ * Hash everything activate() depends on, the node keys
+ * are not part of it since compile() remapped them to slots
+ *
+ * @brief feed_forward_network::structural_hash
+ * @return
+ *
+ ****************************************************/
+template<typename T>
+uint64_t cann::basic_feed_forward_network<T>::structural_hash() const
+{
+    uint64_t ui_hash = 14695981039346656037ULL;
+    auto add = [&ui_hash](const void *p_data, size_t us_size) {
+        const unsigned char *p_bytes = static_cast<const unsigned char *>(p_data);
+        for (size_t us_it = 0; us_it < us_size; us_it++)
+        {
+            ui_hash = (ui_hash ^ p_bytes[us_it]) * 1099511628211ULL;
+        }
+    };
+
+    uint64_t ui_inputs = input_keys.size();
+    uint64_t ui_slots = values.size();
+    add(&ui_inputs, sizeof(ui_inputs));
+    add(&ui_slots, sizeof(ui_slots));
+    add(output_slots.data(), output_slots.size() * sizeof(unsigned int));
+
+    for (auto &it_neuron : neurons)
+    {
+        add(&it_neuron.slot, sizeof(it_neuron.slot));
+        add(&it_neuron.aggregation_function, sizeof(it_neuron.aggregation_function));
+        add(&it_neuron.activation_function, sizeof(it_neuron.activation_function));
+        add(&it_neuron.response, sizeof(it_neuron.response));
+        add(&it_neuron.bias, sizeof(it_neuron.bias));
+
+        uint64_t ui_links = it_neuron.last_link - it_neuron.first_link;
+        add(&ui_links, sizeof(ui_links));
+        for (unsigned int ui_link = it_neuron.first_link; ui_link < it_neuron.last_link; ui_link++)
+        {
+            add(&links[ui_link].slot, sizeof(links[ui_link].slot));
+            add(&links[ui_link].weight, sizeof(links[ui_link].weight));
+        }
     }
+
+    return ui_hash;
 }
 
-void cann::feed_forward_network::activate(std::vector<double> &inputs, std::vector<double> &outputs)
+template<typename T>
+void cann::basic_feed_forward_network<T>::activate(std::vector<T> &inputs, std::vector<T> &outputs)
 {
     // Check if inputs.size == input_keys.size
     if (inputs.size() != this->input_keys.size())
@@ -303,36 +729,66 @@ void cann::feed_forward_network::activate(std::vector<double> &inputs, std::vect
         throw std::runtime_error("Inputs.size() != input_keys.size()");
     }
 
-    //Define
-    double s;
+    if (outputs.size() >= this->output_slots.size())
+    {
+        this->activate(inputs.data(), outputs.data());
+    } else {
 
-    // Set input values
-    size_t us_inputsSize = inputs.size();
-    for (size_t i = 0; i < us_inputsSize; i++)
+        std::vector<T> vec_out(this->output_slots.size());
+        this->activate(inputs.data(), vec_out.data());
+        std::copy(vec_out.begin(), vec_out.begin() + outputs.size(), outputs.begin());
+    }
+}
+
+/****************************************************
+ *
+ * Evaluate one row of input_keys.size() values,
+ * writes output_keys.size() values to outputs.
+ *
+ * @brief feed_forward_network::activate
+ * @param inputs
+ * @param outputs
+ *
+ ****************************************************/
+template<typename T>
+void cann::basic_feed_forward_network<T>::activate(const T *inputs, T *outputs)
+{
+    if (this->engine == 1)
     {
-        //values[ input_keys[i] ] = inputs[i];
-        values.find(input_keys[i])->second = inputs[i];
+        this->activate_bytecode(inputs, outputs);
+        return;
     }
 
+    //Define
+    T s;
+    T *p_values = this->values.data();
+    const link *p_links = this->links.data();
+
+    // Set input values, the inputs occupy the first slots
+    std::copy(inputs, inputs + this->input_keys.size(), p_values);
+
     // Computation loop
-    for (auto it_neuron : node_evals)
+    for (const compiled_neuron &it_neuron : this->neurons)
     {
+        const link *p_first = p_links + it_neuron.first_link;
+        const link *p_last = p_links + it_neuron.last_link;
+
         // Aggregation function
         switch (it_neuron.aggregation_function)
         {
             case 0:
-                s = agg_sum(it_neuron.inputs);
+                s = agg_sum(p_first, p_last);
                 break;
 
             case 1:
-                s = agg_prod(it_neuron.inputs);
+                s = agg_prod(p_first, p_last);
                 break;
 
             case 2:
-                s = agg_mean(it_neuron.inputs);
+                s = agg_mean(p_first, p_last);
                 break;
             default:
-                s = agg_sum(it_neuron.inputs);
+                s = agg_sum(p_first, p_last);
                 break;
         }
 
@@ -340,27 +796,299 @@ void cann::feed_forward_network::activate(std::vector<double> &inputs, std::vect
         switch (it_neuron.activation_function)
         {
             case 0:
-                this->values[it_neuron.node] = act_sig(s * it_neuron.response + it_neuron.bias);
+                p_values[it_neuron.slot] = act_sig(s * it_neuron.response + it_neuron.bias);
                 break;
 
             case 1:
-                this->values[it_neuron.node] = act_tanh(s * it_neuron.response + it_neuron.bias);
+                p_values[it_neuron.slot] = act_tanh(s * it_neuron.response + it_neuron.bias);
                 break;
 
             case 2:
-                this->values[it_neuron.node] = act_sin(s * it_neuron.response + it_neuron.bias);
+                p_values[it_neuron.slot] = act_sin(s * it_neuron.response + it_neuron.bias);
                 break;
             default:
-                this->values[it_neuron.node] = act_sig(s * it_neuron.response + it_neuron.bias);
+                p_values[it_neuron.slot] = act_sig(s * it_neuron.response + it_neuron.bias);
                 break;
         }
     }
 
     // Push output values to output vector
-    size_t us_outputSize = outputs.size();
+    size_t us_outputSize = this->output_slots.size();
+    for (size_t us_it = 0; us_it < us_outputSize; us_it++)
+    {
+        outputs[us_it] = p_values[this->output_slots[us_it]];
+    }
+}
+
+/****************************************************
+ *
+ * Select the engine of activate(const T *, T *)
+ *
+ * @brief feed_forward_network::set_engine
+ * @param engine 0 == switch per neuron, 1 == bytecode
+ *
+ ****************************************************/
+template<typename T>
+void cann::basic_feed_forward_network<T>::set_engine(int engine)
+{
+    this->engine = engine;
+}
+
+/****************************************************
+ *
+ * Run the bytecode program, every instruction jumps
+ * straight to the body of the next opcode, so there is
+ * no shared switch whose branch has to be predicted.
+ * Falls back to a switch loop without labels as values.
+ *
+ * @brief feed_forward_network::activate_bytecode
+ * @param inputs
+ * @param outputs
+ *
+ ****************************************************/
+template<typename T>
+void cann::basic_feed_forward_network<T>::activate_bytecode(const T *inputs, T *outputs)
+{
+    //Define
+    T *p_values = this->values.data();
+    const link *p_links = this->links.data();
+    const instruction *p_ins = this->program.data();
+
+    // Set input values, the inputs occupy the first slots
+    std::copy(inputs, inputs + this->input_keys.size(), p_values);
+
+#if defined(__GNUC__)
+    static const void *p_dispatch[] = {&&op_sum_sig, &&op_sum_tanh, &&op_sum_sin,
+                                       &&op_prod_sig, &&op_prod_tanh, &&op_prod_sin,
+                                       &&op_mean_sig, &&op_mean_tanh, &&op_mean_sin,
+                                       &&op_end};
+#define CANN_OP(label, opcode) label:
+#define CANN_NEXT() goto *p_dispatch[(++p_ins)->opcode]
+#define CANN_AGG(function) function(p_links + p_ins->first_link, p_links + p_ins->last_link) * p_ins->response + p_ins->bias
+
+    goto *p_dispatch[p_ins->opcode];
+#else
+#define CANN_OP(label, opcode) case opcode:
+#define CANN_NEXT() ++p_ins; continue
+#define CANN_AGG(function) function(p_links + p_ins->first_link, p_links + p_ins->last_link) * p_ins->response + p_ins->bias
+
+    for (;;)
+    {
+        switch (p_ins->opcode)
+        {
+#endif
+
+    // Computation loop
+    CANN_OP(op_sum_sig, 0)
+        p_values[p_ins->slot] = act_sig(CANN_AGG(agg_sum));
+        CANN_NEXT();
+
+    CANN_OP(op_sum_tanh, 1)
+        p_values[p_ins->slot] = act_tanh(CANN_AGG(agg_sum));
+        CANN_NEXT();
+
+    CANN_OP(op_sum_sin, 2)
+        p_values[p_ins->slot] = act_sin(CANN_AGG(agg_sum));
+        CANN_NEXT();
+
+    CANN_OP(op_prod_sig, 3)
+        p_values[p_ins->slot] = act_sig(CANN_AGG(agg_prod));
+        CANN_NEXT();
+
+    CANN_OP(op_prod_tanh, 4)
+        p_values[p_ins->slot] = act_tanh(CANN_AGG(agg_prod));
+        CANN_NEXT();
+
+    CANN_OP(op_prod_sin, 5)
+        p_values[p_ins->slot] = act_sin(CANN_AGG(agg_prod));
+        CANN_NEXT();
+
+    CANN_OP(op_mean_sig, 6)
+        p_values[p_ins->slot] = act_sig(CANN_AGG(agg_mean));
+        CANN_NEXT();
+
+    CANN_OP(op_mean_tanh, 7)
+        p_values[p_ins->slot] = act_tanh(CANN_AGG(agg_mean));
+        CANN_NEXT();
+
+    CANN_OP(op_mean_sin, 8)
+        p_values[p_ins->slot] = act_sin(CANN_AGG(agg_mean));
+        CANN_NEXT();
+
+    CANN_OP(op_end, 9)
+        goto op_done;
+
+#if !defined(__GNUC__)
+            default:
+                goto op_done;
+        }
+    }
+#endif
+
+#undef CANN_OP
+#undef CANN_NEXT
+#undef CANN_AGG
+
+    op_done:
+
+    // Push output values to output vector
+    size_t us_outputSize = this->output_slots.size();
     for (size_t us_it = 0; us_it < us_outputSize; us_it++)
     {
-        outputs[us_it] = this->values[us_it];
+        outputs[us_it] = p_values[this->output_slots[us_it]];
+    }
+}
+
+namespace {
+
+    /****************************************************
+     * Activation of one column of a block with cann::simd
+     ****************************************************/
+    void activate_column(int activation_function, const double *in, double *out)
+    {
+        switch (activation_function)
+        {
+            case 1:
+                cann::simd::act_tanh(in, out, us_BatchBlock);
+                break;
+
+            case 2:
+                cann::simd::act_sin(in, out, us_BatchBlock);
+                break;
+
+            default:
+                cann::simd::act_sig(in, out, us_BatchBlock);
+                break;
+        }
+    }
+
+    // The kernels are double only, float columns are widened and rounded back
+    void activate_column(int activation_function, const float *in, float *out)
+    {
+        double wide[us_BatchBlock];
+        std::copy(in, in + us_BatchBlock, wide);
+        activate_column(activation_function, wide, wide);
+        std::copy(wide, wide + us_BatchBlock, out);
+    }
+
+} // End of anonymous namespace
+
+/****************************************************
+ *
+ * Evaluate us_rows rows layer by layer instead of row by row.
+ * The rows are processed in blocks of us_BatchBlock timesteps, every slot
+ * owns one column of the block. Each neuron sweeps its links over all
+ * timesteps of the block, so the weight stays in a register while the
+ * source columns stream through unit-stride loops.
+ * Activations use cann::simd, results may differ from activate() by a few ulp.
+ *
+ * @brief feed_forward_network::activate_batch
+ * @param rows
+ * @param us_rows
+ * @param stride
+ * @param outputs
+ *
+ ****************************************************/
+template<typename T>
+void cann::basic_feed_forward_network<T>::activate_batch(const T *rows, size_t us_rows, ptrdiff_t stride, T *outputs)
+{
+    // Columns of slots which are never evaluated have to stay 0.0
+    if (this->batch_values.empty())
+    {
+        this->batch_values.assign(this->values.size() * us_BatchBlock, 0.0);
+    }
+
+    T *p_batch = this->batch_values.data();
+    const link *p_links = this->links.data();
+    size_t us_outputSize = this->output_slots.size();
+    T acc[us_BatchBlock];
+
+    for (size_t us_first = 0; us_first < us_rows; us_first += us_BatchBlock)
+    {
+        size_t us_count = std::min(us_rows - us_first, us_BatchBlock);
+        const T *p_rows = rows + static_cast<ptrdiff_t>(us_first) * stride;
+
+        // Transpose the used inputs, pad the last block so every sweep has the full length
+        for (auto it_slot : this->batch_inputs)
+        {
+            T *p_column = p_batch + it_slot * us_BatchBlock;
+            for (size_t t = 0; t < us_count; t++)
+            {
+                p_column[t] = p_rows[static_cast<ptrdiff_t>(t) * stride + it_slot];
+            }
+            for (size_t t = us_count; t < us_BatchBlock; t++)
+            {
+                p_column[t] = 0.0;
+            }
+        }
+
+        // Computation loop
+        for (const compiled_neuron &it_neuron : this->neurons)
+        {
+            const link *p_first = p_links + it_neuron.first_link;
+            const link *p_last = p_links + it_neuron.last_link;
+
+            for (size_t t = 0; t < us_BatchBlock; t++)
+            {
+                acc[t] = 0.0;
+            }
+
+            // Aggregation function
+            if (it_neuron.aggregation_function == 1)
+            {
+                for (const link *p_link = p_first; p_link != p_last; ++p_link)
+                {
+                    const T *p_source = p_batch + p_link->slot * us_BatchBlock;
+                    const T weight = p_link->weight;
+                    for (size_t t = 0; t < us_BatchBlock; t++)
+                    {
+                        acc[t] *= p_source[t] * weight;
+                    }
+                }
+            } else {
+
+                for (const link *p_link = p_first; p_link != p_last; ++p_link)
+                {
+                    const T *p_source = p_batch + p_link->slot * us_BatchBlock;
+                    const T weight = p_link->weight;
+                    for (size_t t = 0; t < us_BatchBlock; t++)
+                    {
+                        acc[t] += p_source[t] * weight;
+                    }
+                }
+
+                if (it_neuron.aggregation_function == 2)
+                {
+                    const size_t us_links = static_cast<size_t>(p_last - p_first);
+                    for (size_t t = 0; t < us_BatchBlock; t++)
+                    {
+                        acc[t] = acc[t] / us_links;
+                    }
+                }
+            }
+
+            // Activation function
+            T *p_column = p_batch + it_neuron.slot * us_BatchBlock;
+            const T response = it_neuron.response;
+            const T bias = it_neuron.bias;
+
+            for (size_t t = 0; t < us_BatchBlock; t++)
+            {
+                acc[t] = acc[t] * response + bias;
+            }
+
+            activate_column(it_neuron.activation_function, acc, p_column);
+        }
+
+        // Push output columns to the output rows
+        for (size_t us_it = 0; us_it < us_outputSize; us_it++)
+        {
+            const T *p_column = p_batch + this->output_slots[us_it] * us_BatchBlock;
+            for (size_t t = 0; t < us_count; t++)
+            {
+                outputs[(us_first + t) * us_outputSize + us_it] = p_column[t];
+            }
+        }
     }
 }
 
@@ -378,12 +1106,13 @@ void cann::feed_forward_network::activate(std::vector<double> &inputs, std::vect
  * @return
  *
  *****************************************************/
-double cann::feed_forward_network::agg_sum(std::vector<std::pair<int, double>> &links)
+template<typename T>
+T cann::basic_feed_forward_network<T>::agg_sum(const link *first, const link *last)
 {
-    double ret = 0.0;
-    for (auto it_link : links)
+    T ret = 0.0;
+    for (; first != last; ++first)
     {
-        ret += values[it_link.first] * it_link.second;
+        ret += values[first->slot] * first->weight;
     }
 
     return ret;
@@ -398,16 +1127,16 @@ double cann::feed_forward_network::agg_sum(std::vector<std::pair<int, double>> &
  * @return
  *
  ****************************************************/
-double cann::feed_forward_network::agg_prod(std::vector<std::pair<int, double>> &links)
+template<typename T>
+T cann::basic_feed_forward_network<T>::agg_prod(const link *first, const link *last)
 {
-    double ret = 0.0;
-    for (auto it_link : links)
+    T ret = 0.0;
+    for (; first != last; ++first)
     {
-        ret *= values[it_link.first] * it_link.second;
+        ret *= values[first->slot] * first->weight;
     }
 
     return ret;
-
 }
 
 /****************************************************
@@ -419,17 +1148,18 @@ double cann::feed_forward_network::agg_prod(std::vector<std::pair<int, double>>
  * @return
  *
  ****************************************************/
-double cann::feed_forward_network::agg_mean(std::vector<std::pair<int, double>> &links)
+template<typename T>
+T cann::basic_feed_forward_network<T>::agg_mean(const link *first, const link *last)
 {
-    double ret = 0.0;
-    for (auto it_link : links)
+    T ret = 0.0;
+    size_t us_count = static_cast<size_t>(last - first);
+    for (; first != last; ++first)
     {
-        ret += values[it_link.first] * it_link.second;
+        ret += values[first->slot] * first->weight;
     }
-    ret = ret / links.size();
+    ret = ret / us_count;
 
     return ret;
-
 }
 
 
@@ -446,9 +1176,10 @@ double cann::feed_forward_network::agg_mean(std::vector<std::pair<int, double>>
  * @return
  *
  ****************************************************/
-double cann::feed_forward_network::act_sig(double in)
+template<typename T>
+T cann::basic_feed_forward_network<T>::act_sig(T in)
 {
-    return 1 / (1 + exp(-1 * in));
+    return 1 / (1 + std::exp(-1 * in));
 }
 
 /****************************************************
@@ -460,9 +1191,10 @@ double cann::feed_forward_network::act_sig(double in)
  * @return
  *
  ****************************************************/
-double cann::feed_forward_network::act_sin(double in)
+template<typename T>
+T cann::basic_feed_forward_network<T>::act_sin(T in)
 {
-    return sin(in);
+    return std::sin(in);
 }
 
 /****************************************************
@@ -474,7 +1206,13 @@ double cann::feed_forward_network::act_sin(double in)
  * @return
  *
  ****************************************************/
-double cann::feed_forward_network::act_tanh(double in)
+template<typename T>
+T cann::basic_feed_forward_network<T>::act_tanh(T in)
 {
-    return tanh(in);
-}
\ No newline at end of file
+    return std::tanh(in);
+}
+
+
+// Scalar types of the network
+template class cann::basic_feed_forward_network<double>;
+template class cann::basic_feed_forward_network<float>;
@@ -9,9 +9,12 @@
 // C / C++
 #include <iostream>
 #include <vector>
+#include <unordered_map>
 #include <fstream>
 #include <string>
 #include <cmath>
+#include <cstdint>
+#include <cstddef>
 
 // External
 #include <cereal/cereal.hpp>
@@ -22,6 +25,7 @@
 
 // Project
 #include <cneat.h>
+#include <cann_simd.h>
 
 
 namespace cann {
@@ -50,15 +54,127 @@ namespace cann {
     } neuron;
 
 
+    /**
+     * Compiled link: dense value slot of the source node and the connection weight
+     */
+    template<typename T>
+    struct basic_link {
+
+        unsigned int slot;
+        T weight;
+
+        // Serialization
+        template<class Archive>
+        void serialize(Archive &archive) {
+
+            archive(slot,
+                    weight);
+        }
+
+    };
+
+    typedef basic_link<double> link;
+
+
+    /**
+     * Compiled neuron: dense value slot of the node and its incoming links [first_link, last_link)
+     */
+    template<typename T>
+    struct basic_compiled_neuron {
+
+        unsigned int slot;
+        int aggregation_function;
+        int activation_function;
+        T response;
+        T bias;
+        unsigned int first_link;
+        unsigned int last_link;
+
+        // Serialization
+        template<class Archive>
+        void serialize(Archive &archive) {
+
+            archive(slot,
+                    aggregation_function,
+                    activation_function,
+                    response,
+                    bias,
+                    first_link,
+                    last_link);
+        }
+
+    };
+
+    typedef basic_compiled_neuron<double> compiled_neuron;
+
+
+    /**
+     * Bytecode instruction: one neuron with its fused (aggregation, activation) opcode,
+     * opcode = aggregation_function * 3 + activation_function, the program ends with op_end
+     */
+    template<typename T>
+    struct basic_instruction {
+
+        unsigned int opcode;
+        unsigned int slot;
+        unsigned int first_link;
+        unsigned int last_link;
+        T response;
+        T bias;
+
+        // Serialization
+        template<class Archive>
+        void serialize(Archive &archive) {
+
+            archive(opcode,
+                    slot,
+                    first_link,
+                    last_link,
+                    response,
+                    bias);
+        }
+
+    };
+
+    typedef basic_instruction<double> instruction;
+
+
+    /**
+     * Result of basic_feed_forward_network::optimize, sizes of node_evals before and after
+     */
+    typedef struct {
+
+        size_t nodes_before;
+        size_t nodes_after;
+        size_t links_before;
+        size_t links_after;
+        size_t constants_folded;
+        size_t links_merged;
+
+    } optimization_report;
+
+
     /******************************************************************************************************************************************************************************
      *
      * Neural network class for feed forward networks
      * No recurency, working with layers
+     * T is the scalar type of weights, values, inputs and outputs (double or float),
+     * the genome is always read in double
      *
-     * @brief The feed_forward_network class
+     * @brief The basic_feed_forward_network class
      *
      ******************************************************************************************************************************************************************************/
-    class feed_forward_network {
+    template<typename T>
+    class basic_feed_forward_network {
+
+        // Emits native code for the compiled phenotype
+        friend class compiled_network;
+
+    public:
+        typedef T value_type;
+        typedef basic_link<T> link;
+        typedef basic_compiled_neuron<T> compiled_neuron;
+        typedef basic_instruction<T> instruction;
 
     private:
         // Perma stuff
@@ -66,23 +182,44 @@ namespace cann {
         std::vector<int> output_keys;
         std::vector<neuron> node_evals;
 
+        // Compiled phenotype: node keys remapped to dense slots, inputs first, then outputs
+        std::vector<unsigned int> output_slots;
+        std::vector<compiled_neuron> neurons;
+        std::vector<link> links;
+
+        // Same neurons as bytecode, run by activate_bytecode
+        std::vector<instruction> program;
+
+        // Input slots read by activate_batch
+        std::vector<unsigned int> batch_inputs;
+
+        // Engine of activate(const T *, T *): 0 == switch per neuron, 1 == bytecode
+        int engine = 0;
+
         //Changes every activation
-        std::unordered_map<int, double> values;
+        std::vector<T> values;
+        std::vector<T> batch_values;
 
     public:
         /****************************************************
          * Default constructor
          ****************************************************/
-        feed_forward_network();
+        basic_feed_forward_network();
 
         /****************************************************
          * Default Destructor
          *****************************************************/
-        ~feed_forward_network() {
+        ~basic_feed_forward_network() {
             input_keys.clear();
             output_keys.clear();
             node_evals.clear();
+            output_slots.clear();
+            neurons.clear();
+            links.clear();
+            program.clear();
+            batch_inputs.clear();
             values.clear();
+            batch_values.clear();
         }
 
 
@@ -97,31 +234,65 @@ namespace cann {
 
         void from_genome(cneat::genome &g);
 
+        void compile();
+
+        /****************************************************
+         * Simplify node_evals and compile again: constant nodes are folded into
+         * downstream biases, duplicate links merged, links with |weight| <= prune_weight
+         * and nodes which no longer reach an output removed.
+         * Results equal the unoptimized network up to rounding.
+         ****************************************************/
+        optimization_report optimize(double prune_weight = 0.0);
+
+        /****************************************************
+         * 64 bit FNV-1a hash of the compiled phenotype (slots, functions, weights),
+         * equal for genomes which evaluate the same
+         ****************************************************/
+        uint64_t structural_hash() const;
+
 
         /****************************************************
          * Evalutae the genome
          ****************************************************/
-        void activate(std::vector<double> &inputs, std::vector<double> &outputs);
+        void activate(std::vector<T> &inputs, std::vector<T> &outputs);
+
+        void activate(const T *inputs, T *outputs);
+
+        void set_engine(int engine);
+
+        /****************************************************
+         * Evaluate the genome with the bytecode interpreter,
+         * same results as the switch engine
+         ****************************************************/
+        void activate_bytecode(const T *inputs, T *outputs);
+
+        /****************************************************
+         * Evaluate us_rows rows at once, row t starts at rows + t * stride,
+         * the stride may be negative (see WindowView).
+         * The outputs of row t are written to outputs + t * output_keys.size().
+         * Activations use cann::simd, results may differ from activate() by a few ulp.
+         ****************************************************/
+        void activate_batch(const T *rows, size_t us_rows, ptrdiff_t stride, T *outputs);
 
 
         /****************************************************
          * Aggregation functions
          ****************************************************/
-        inline double agg_sum(std::vector<std::pair<int, double>> &links);
+        inline T agg_sum(const link *first, const link *last);
 
-        inline double agg_mean(std::vector<std::pair<int, double>> &links);
+        inline T agg_mean(const link *first, const link *last);
 
-        inline double agg_prod(std::vector<std::pair<int, double>> &links);
+        inline T agg_prod(const link *first, const link *last);
 
 
         /****************************************************
          * Activation functions
          ****************************************************/
-        inline double act_sin(double in);
+        inline T act_sin(T in);
 
-        inline double act_tanh(double in);
+        inline T act_tanh(T in);
 
-        inline double act_sig(double in);
+        inline T act_sig(T in);
 
         /****************************************************
          * Utils
@@ -135,12 +306,26 @@ namespace cann {
             archive(input_keys,
                     output_keys,
                     node_evals,
+                    output_slots,
+                    neurons,
+                    links,
+                    program,
+                    batch_inputs,
+                    engine,
                     values);
+
+            // Scratch of activate_batch, sized again for the loaded network
+            batch_values.clear();
         }
 
 
     };
 
+    typedef basic_feed_forward_network<double> feed_forward_network;
+
+    extern template class basic_feed_forward_network<double>;
+    extern template class basic_feed_forward_network<float>;
+
 } // End of namesace cann
 
 #endif //CNEAT_TRADER_CANN_H
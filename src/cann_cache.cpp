@@ -0,0 +1,207 @@
+//
+//  cann_cache.cpp
+//  CNT
+//
+
+// C / C++
+
+// External
+
+// Project
+#include "cann_cache.h"
+#include "cann.h"
+#include "cann_recurrent.h"
+
+
+uint64_t cann::fnv1a(const void *p_data, size_t us_size, uint64_t ui_hash)
+{
+    const unsigned char *p_bytes = static_cast<const unsigned char *>(p_data);
+    for (size_t us_it = 0; us_it < us_size; us_it++)
+    {
+        ui_hash = (ui_hash ^ p_bytes[us_it]) * 1099511628211ULL;
+    }
+
+    return ui_hash;
+}
+
+/****************************************************
+ *
+ * Connection order is part of the hash: it decides the
+ * order of the links, and so the rounding of the sums.
+ * Disabled connections count without their weight,
+ * feed_forward_layers() still sees them.
+ *
+ * @brief genome_hash
+ * @param g
+ * @param ui_hash Seed, e.g. a hash of the settings the phenotype is built with
+ * @return
+ *
+ ****************************************************/
+uint64_t cann::genome_hash(const cneat::genome &g, uint64_t ui_hash)
+{
+    auto add = [&ui_hash](const void *p_data, size_t us_size) {
+        ui_hash = fnv1a(p_data, us_size, ui_hash);
+    };
+
+    uint64_t ui_size = g.input_pins.size();
+    add(&ui_size, sizeof(ui_size));
+    add(g.input_pins.data(), g.input_pins.size() * sizeof(int));
+    ui_size = g.output_pins.size();
+    add(&ui_size, sizeof(ui_size));
+    add(g.output_pins.data(), g.output_pins.size() * sizeof(int));
+
+    ui_size = g.node_genes.size();
+    add(&ui_size, sizeof(ui_size));
+    for (auto &it_node : g.node_genes)
+    {
+        add(&it_node.key, sizeof(it_node.key));
+        add(&it_node.activation_function, sizeof(it_node.activation_function));
+        add(&it_node.aggregation_function, sizeof(it_node.aggregation_function));
+        add(&it_node.bias, sizeof(it_node.bias));
+        add(&it_node.response, sizeof(it_node.response));
+    }
+
+    ui_size = g.connection_genes.size();
+    add(&ui_size, sizeof(ui_size));
+    for (auto &it_connection : g.connection_genes)
+    {
+        unsigned char uc_enabled = it_connection.enabled ? 1 : 0;
+        add(&it_connection.from_node, sizeof(it_connection.from_node));
+        add(&it_connection.to_node, sizeof(it_connection.to_node));
+        add(&uc_enabled, sizeof(uc_enabled));
+        if (uc_enabled)
+        {
+            add(&it_connection.weight, sizeof(it_connection.weight));
+        }
+    }
+
+    return ui_hash;
+}
+
+
+/****************************************************
+ * Constructor
+ ****************************************************/
+template<class Network>
+cann::phenotype_cache<Network>::phenotype_cache(size_t capacity)
+        : capacity(capacity), report({0, 0, 0})
+{
+
+}
+
+/****************************************************
+ *
+ * Look up ui_key and mark it as most recently used
+ *
+ * @brief phenotype_cache::find
+ * @param ui_key
+ * @return The phenotype or nullptr
+ *
+ ****************************************************/
+template<class Network>
+typename cann::phenotype_cache<Network>::pointer cann::phenotype_cache<Network>::find(uint64_t ui_key)
+{
+    std::lock_guard<std::mutex> s_Guard(this->mutex);
+
+    auto it_entry = this->index.find(ui_key);
+    if (it_entry == this->index.end())
+    {
+        ++this->report.misses;
+        return nullptr;
+    }
+
+    ++this->report.hits;
+    this->entries.splice(this->entries.begin(), this->entries, it_entry->second);
+    return it_entry->second->second;
+}
+
+/****************************************************
+ *
+ * Insert or replace the phenotype of ui_key. Two threads
+ * may build the same genome, the last one wins.
+ *
+ * @brief phenotype_cache::insert
+ * @param ui_key
+ * @param p_Network
+ * @return Number of evicted entries
+ *
+ ****************************************************/
+template<class Network>
+size_t cann::phenotype_cache<Network>::insert(uint64_t ui_key, pointer p_Network)
+{
+    std::lock_guard<std::mutex> s_Guard(this->mutex);
+
+    if (this->capacity == 0)
+    {
+        return 0;
+    }
+
+    auto it_entry = this->index.find(ui_key);
+    if (it_entry != this->index.end())
+    {
+        it_entry->second->second = p_Network;
+        this->entries.splice(this->entries.begin(), this->entries, it_entry->second);
+        return 0;
+    }
+
+    this->entries.emplace_front(ui_key, p_Network);
+    this->index.emplace(ui_key, this->entries.begin());
+
+    return this->evict();
+}
+
+template<class Network>
+size_t cann::phenotype_cache<Network>::evict()
+{
+    size_t us_evicted = 0;
+    while (this->entries.size() > this->capacity)
+    {
+        this->index.erase(this->entries.back().first);
+        this->entries.pop_back();
+        ++us_evicted;
+    }
+
+    this->report.evictions += us_evicted;
+    return us_evicted;
+}
+
+template<class Network>
+void cann::phenotype_cache<Network>::set_capacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> s_Guard(this->mutex);
+
+    this->capacity = capacity;
+    this->evict();
+}
+
+template<class Network>
+void cann::phenotype_cache<Network>::clear()
+{
+    std::lock_guard<std::mutex> s_Guard(this->mutex);
+
+    this->entries.clear();
+    this->index.clear();
+}
+
+template<class Network>
+cann::cache_report cann::phenotype_cache<Network>::get_report()
+{
+    std::lock_guard<std::mutex> s_Guard(this->mutex);
+
+    return this->report;
+}
+
+template<class Network>
+size_t cann::phenotype_cache<Network>::size()
+{
+    std::lock_guard<std::mutex> s_Guard(this->mutex);
+
+    return this->entries.size();
+}
+
+
+// Phenotypes evaluated by the backtests
+template class cann::phenotype_cache<cann::basic_feed_forward_network<double>>;
+template class cann::phenotype_cache<cann::basic_feed_forward_network<float>>;
+template class cann::phenotype_cache<cann::basic_recurrent_network<double>>;
+template class cann::phenotype_cache<cann::basic_recurrent_network<float>>;
@@ -0,0 +1,126 @@
+//
+//  cann_cache.h
+//  CNT
+//
+
+#ifndef CNEAT_TRADER_CANN_CACHE_H
+#define CNEAT_TRADER_CANN_CACHE_H
+
+
+// C / C++
+#include <list>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <unordered_map>
+
+// External
+
+// Project
+#include <cneat.h>
+
+
+namespace cann {
+
+    /**
+     * Counters of a phenotype_cache, or summed over the lookups of an evaluation
+     */
+    typedef struct {
+
+        size_t hits;
+        size_t misses;
+        size_t evictions;
+
+    } cache_report;
+
+
+    // FNV-1a offset basis, the seed of an empty hash
+    const uint64_t ui_HashSeed = 14695981039346656037ULL;
+
+    /****************************************************
+     * 64 bit FNV-1a hash of us_size bytes, continues ui_hash
+     ****************************************************/
+    uint64_t fnv1a(const void *p_data, size_t us_size, uint64_t ui_hash = ui_HashSeed);
+
+    /****************************************************
+     * 64 bit FNV-1a hash of everything from_genome() reads: pins, node genes
+     * and connection genes in gene order, weights of enabled connections only.
+     * Equal for a genome and its unmutated copies.
+     ****************************************************/
+    uint64_t genome_hash(const cneat::genome &g, uint64_t ui_hash = ui_HashSeed);
+
+
+    /******************************************************************************************************************************************************************************
+     *
+     * Bounded map from a genome hash to a built phenotype, shared by the evaluation threads.
+     * Phenotypes are immutable once inserted, users copy them before activating.
+     * The least recently used phenotype is evicted once size() would exceed the capacity.
+     * All members lock one mutex, a lookup is a hash and a list splice.
+     *
+     * Network is the phenotype, basic_feed_forward_network<T> or basic_recurrent_network<T>.
+     *
+     * @brief The phenotype_cache class
+     *
+     ******************************************************************************************************************************************************************************/
+    template<class Network>
+    class phenotype_cache {
+
+    public:
+        typedef std::shared_ptr<const Network> pointer;
+
+    private:
+        typedef std::list<std::pair<uint64_t, pointer>> entry_list;
+
+        // Most recently used first
+        entry_list entries;
+        std::unordered_map<uint64_t, typename entry_list::iterator> index;
+
+        size_t capacity;
+        cache_report report;
+
+        std::mutex mutex;
+
+        /****************************************************
+         * Drop the least recently used entries above capacity
+         ****************************************************/
+        size_t evict();
+
+    public:
+        /****************************************************
+         * Constructor, a capacity of 0 disables the cache
+         ****************************************************/
+        explicit phenotype_cache(size_t capacity = 0);
+
+
+        /****************************************************
+         * Phenotype of ui_key or nullptr, counts a hit or a miss
+         ****************************************************/
+        pointer find(uint64_t ui_key);
+
+        /****************************************************
+         * Store a phenotype, returns the number of evicted entries
+         ****************************************************/
+        size_t insert(uint64_t ui_key, pointer p_Network);
+
+        /****************************************************
+         * Change the bound, evicts if it shrinks
+         ****************************************************/
+        void set_capacity(size_t capacity);
+
+        /****************************************************
+         * Remove all entries, the counters are kept
+         ****************************************************/
+        void clear();
+
+        /****************************************************
+         * Counters since construction
+         ****************************************************/
+        cache_report get_report();
+
+        size_t size();
+
+    };
+
+} // End of namesace cann
+
+#endif //CNEAT_TRADER_CANN_CACHE_H
@@ -0,0 +1,380 @@
+//
+//  cann_compiled.cpp
+//  CNT
+//
+
+// C / C++
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// External
+
+// Project
+#include "cann_compiled.h"
+
+
+namespace {
+
+    // Bumped whenever the emitted code changes, so old cache entries are not loaded
+    const unsigned int ui_SourceVersion = 1;
+
+    // Distinguishes temporary files of concurrent builds in one process
+    std::atomic<unsigned int> ui_BuildCounter(0);
+
+    /****************************************************
+     * Literal which reproduces f64_X exactly
+     ****************************************************/
+    std::string literal(double f64_X)
+    {
+        if (std::isnan(f64_X))
+        {
+            return "std::numeric_limits<double>::quiet_NaN()";
+        }
+        if (std::isinf(f64_X))
+        {
+            return f64_X > 0 ? "std::numeric_limits<double>::infinity()" : "-std::numeric_limits<double>::infinity()";
+        }
+
+        // 17 significant digits round-trip, keep a double literal so -0.0 stays negative
+        char c_buffer[64];
+        std::snprintf(c_buffer, sizeof(c_buffer), "%.17g", f64_X);
+        std::string s_literal(c_buffer);
+        if (s_literal.find_first_of(".e") == std::string::npos)
+        {
+            s_literal += ".0";
+        }
+        return "(" + s_literal + ")";
+    }
+
+    /****************************************************
+     * Quote s_Argument for /bin/sh
+     ****************************************************/
+    std::string shell_quote(const std::string &s_Argument)
+    {
+        std::string s_quoted = "'";
+        for (char c : s_Argument)
+        {
+            if (c == '\'')
+            {
+                s_quoted += "'\\''";
+            } else {
+                s_quoted += c;
+            }
+        }
+        return s_quoted + "'";
+    }
+
+} // End of anonymous namespace
+
+
+/****************************************************
+ * Constructor
+ ****************************************************/
+cann::compiled_network::compiled_network(const std::string &cache_directory, const std::string &compiler)
+        : cache_directory(cache_directory), compiler(compiler)
+{
+    if (this->compiler.empty())
+    {
+        const char *p_cxx = std::getenv("CXX");
+        this->compiler = p_cxx != nullptr && *p_cxx != '\0' ? p_cxx : "c++";
+    }
+}
+
+/****************************************************
+ *
+ * Build the interpreter, then load the shared object of
+ * the phenotype from the cache or compile it first
+ *
+ * @brief compiled_network::from_genome
+ * @param g
+ *
+ ****************************************************/
+void cann::compiled_network::from_genome(cneat::genome &g)
+{
+    this->network = feed_forward_network();
+    this->network.from_genome(g);
+    this->compile();
+}
+
+/****************************************************
+ *
+ * Build and optimize the interpreter, then compile
+ * the optimized phenotype, see from_genome(g)
+ *
+ * @brief compiled_network::from_genome
+ * @param g
+ * @param prune_weight See feed_forward_network::optimize
+ * @return The optimization report
+ *
+ ****************************************************/
+cann::optimization_report cann::compiled_network::from_genome(cneat::genome &g, double prune_weight)
+{
+    this->network = feed_forward_network();
+    this->network.from_genome(g);
+    optimization_report s_report = this->network.optimize(prune_weight);
+    this->compile();
+
+    return s_report;
+}
+
+/****************************************************
+ *
+ * Load the shared object of the interpreter from the
+ * cache or compile it first
+ *
+ * @brief compiled_network::compile
+ *
+ ****************************************************/
+void cann::compiled_network::compile()
+{
+    this->library.reset();
+    this->native = nullptr;
+
+    uint64_t ui_hash = this->network.structural_hash();
+    char c_name[32];
+    std::snprintf(c_name, sizeof(c_name), "%016llx", static_cast<unsigned long long>(ui_hash));
+    std::string s_library = this->cache_directory + "/cann_" + c_name + ".so";
+
+    if (this->load(s_library, ui_hash))
+    {
+        return;
+    }
+
+    // Not cached, only possible with a shell to run the compiler
+    if (std::system(nullptr) == 0)
+    {
+        return;
+    }
+
+    mkdir(this->cache_directory.c_str(), ACCESSPERMS);
+
+    if (this->build(this->emit_source(ui_hash), s_library))
+    {
+        this->load(s_library, ui_hash);
+    }
+}
+
+/****************************************************
+ *
+ * Straight-line C++ for the compiled neurons. Every
+ * expression is evaluated in the same order as in
+ * feed_forward_network::activate(), and the source is
+ * built without FMA contraction, so the results match.
+ *
+ * @brief compiled_network::emit_source
+ * @param ui_hash
+ * @return
+ *
+ ****************************************************/
+std::string cann::compiled_network::emit_source(uint64_t ui_hash) const
+{
+    const feed_forward_network &ffn = this->network;
+    size_t us_inputs = ffn.input_keys.size();
+    std::vector<bool> b_evaluated(ffn.values.size(), false);
+
+    auto value = [&](unsigned int ui_slot) -> std::string {
+        if (ui_slot < us_inputs)
+        {
+            return "in[" + std::to_string(ui_slot) + "]";
+        }
+        if (b_evaluated[ui_slot])
+        {
+            return "v" + std::to_string(ui_slot);
+        }
+
+        // Never evaluated, stays 0.0 in the interpreter
+        return "0.0";
+    };
+
+    std::ostringstream s_source;
+    s_source << "// Generated by cann::compiled_network, version " << ui_SourceVersion << "\n"
+             << "#include <cmath>\n"
+             << "#include <limits>\n\n"
+             << "extern \"C\" const unsigned long long cann_structural_hash = " << ui_hash << "ULL;\n\n"
+             << "extern \"C\" void cann_activate(const double *in, double *out)\n"
+             << "{\n"
+             << "    double s;\n";
+
+    for (const compiled_neuron &it_neuron : ffn.neurons)
+    {
+        size_t us_links = it_neuron.last_link - it_neuron.first_link;
+
+        // Aggregation function, unknown ones are summed like in activate()
+        s_source << "\n    s = 0.0;\n";
+        for (unsigned int ui_link = it_neuron.first_link; ui_link < it_neuron.last_link; ui_link++)
+        {
+            const link &it_link = ffn.links[ui_link];
+            s_source << "    s " << (it_neuron.aggregation_function == 1 ? "*=" : "+=") << " "
+                     << value(it_link.slot) << " * " << literal(it_link.weight) << ";\n";
+        }
+        if (it_neuron.aggregation_function == 2)
+        {
+            s_source << "    s = s / static_cast<double>(" << us_links << "ULL);\n";
+        }
+
+        // Activation function, unknown ones are sigmoid like in activate()
+        std::string s_in = "(s * " + literal(it_neuron.response) + " + " + literal(it_neuron.bias) + ")";
+        std::string s_out = "v" + std::to_string(it_neuron.slot);
+        switch (it_neuron.activation_function)
+        {
+            case 1:
+                s_source << "    const double " << s_out << " = std::tanh(" << s_in << ");\n";
+                break;
+
+            case 2:
+                s_source << "    const double " << s_out << " = std::sin(" << s_in << ");\n";
+                break;
+
+            default:
+                s_source << "    const double " << s_out << " = 1 / (1 + std::exp(-1 * " << s_in << "));\n";
+                break;
+        }
+        b_evaluated[it_neuron.slot] = true;
+    }
+
+    s_source << "\n";
+    for (size_t us_it = 0; us_it < ffn.output_slots.size(); us_it++)
+    {
+        s_source << "    out[" << us_it << "] = " << value(ffn.output_slots[us_it]) << ";\n";
+    }
+    s_source << "}\n";
+
+    return s_source.str();
+}
+
+/****************************************************
+ *
+ * Compile s_source to s_library. The object is built
+ * under a temporary name and renamed, so concurrent
+ * builds never load a half written file.
+ *
+ * @brief compiled_network::build
+ * @param s_source
+ * @param s_library
+ * @return True on success
+ *
+ ****************************************************/
+bool cann::compiled_network::build(const std::string &s_source, const std::string &s_library) const
+{
+    std::string s_temp = s_library + "." + std::to_string(getpid()) + "." + std::to_string(ui_BuildCounter++);
+    std::string s_sourcePath = s_temp + ".cpp";
+    std::string s_libraryPath = s_temp + ".so";
+
+    FILE *p_file = std::fopen(s_sourcePath.c_str(), "w");
+    if (p_file == nullptr)
+    {
+        return false;
+    }
+    bool b_written = std::fwrite(s_source.data(), 1, s_source.size(), p_file) == s_source.size();
+    b_written = std::fclose(p_file) == 0 && b_written;
+
+    std::string s_command = this->compiler + " -std=c++11 -O2 -ffp-contract=off -fPIC -shared -o " +
+                            shell_quote(s_libraryPath) + " " + shell_quote(s_sourcePath) + " > /dev/null 2>&1";
+    bool b_built = b_written && std::system(s_command.c_str()) == 0 &&
+                   std::rename(s_libraryPath.c_str(), s_library.c_str()) == 0;
+
+    std::remove(s_sourcePath.c_str());
+    if (!b_built)
+    {
+        std::remove(s_libraryPath.c_str());
+    }
+
+    return b_built;
+}
+
+/****************************************************
+ *
+ * dlopen s_library if it exists and was built for
+ * a phenotype with structural hash ui_hash
+ *
+ * @brief compiled_network::load
+ * @param s_library
+ * @param ui_hash
+ * @return True if native code is used
+ *
+ ****************************************************/
+bool cann::compiled_network::load(const std::string &s_library, uint64_t ui_hash)
+{
+    if (access(s_library.c_str(), R_OK) != 0)
+    {
+        return false;
+    }
+
+    void *p_handle = dlopen(s_library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (p_handle == nullptr)
+    {
+        return false;
+    }
+
+    std::shared_ptr<void> library(p_handle, [](void *p) { dlclose(p); });
+    auto p_hash = static_cast<const unsigned long long *>(dlsym(p_handle, "cann_structural_hash"));
+    void *p_activate = dlsym(p_handle, "cann_activate");
+    if (p_hash == nullptr || *p_hash != ui_hash || p_activate == nullptr)
+    {
+        return false;
+    }
+
+    this->library = library;
+    this->native = reinterpret_cast<native_function>(p_activate);
+    return true;
+}
+
+/****************************************************
+ * True if activate() runs native code
+ ****************************************************/
+bool cann::compiled_network::is_native() const
+{
+    return this->native != nullptr;
+}
+
+void cann::compiled_network::activate(std::vector<double> &inputs, std::vector<double> &outputs)
+{
+    if (this->native == nullptr)
+    {
+        this->network.activate(inputs, outputs);
+        return;
+    }
+
+    // Check if inputs.size == input_keys.size
+    if (inputs.size() != this->network.input_keys.size())
+    {
+        ErrorLog::LogError("Inputs.size() != input_keys.size()", "/home/AnnErrorLog.dat");
+        throw std::runtime_error("Inputs.size() != input_keys.size()");
+    }
+
+    if (outputs.size() >= this->network.output_slots.size())
+    {
+        this->native(inputs.data(), outputs.data());
+    } else {
+
+        std::vector<double> vec_out(this->network.output_slots.size());
+        this->native(inputs.data(), vec_out.data());
+        std::copy(vec_out.begin(), vec_out.begin() + outputs.size(), outputs.begin());
+    }
+}
+
+/****************************************************
+ *
+ * Evaluate one row of input_keys.size() values,
+ * writes output_keys.size() values to outputs.
+ *
+ * @brief compiled_network::activate
+ * @param inputs
+ * @param outputs
+ *
+ ****************************************************/
+void cann::compiled_network::activate(const double *inputs, double *outputs)
+{
+    if (this->native != nullptr)
+    {
+        this->native(inputs, outputs);
+    } else {
+        this->network.activate(inputs, outputs);
+    }
+}
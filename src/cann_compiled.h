@@ -0,0 +1,98 @@
+//
+//  cann_compiled.h
+//  CNT
+//
+
+#ifndef CNEAT_TRADER_CANN_COMPILED_H
+#define CNEAT_TRADER_CANN_COMPILED_H
+
+
+// C / C++
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// External
+
+// Project
+#include <cann.h>
+
+
+namespace cann {
+
+    /******************************************************************************************************************************************************************************
+     *
+     * Feed forward network compiled to native code.
+     * from_genome() emits straight-line C++ for the phenotype, builds it with the system compiler
+     * into a shared object and loads it with dlopen. Shared objects are cached in cache_directory,
+     * named by the structural hash of the phenotype, so a genome is only compiled once.
+     * Without a compiler, or if building / loading fails, activate() runs the interpreter.
+     * Results are bit-identical to feed_forward_network::activate().
+     *
+     * Compiling takes a few hundred ms, this only pays off for one genome over millions of rows.
+     *
+     * @brief The compiled_network class
+     *
+     ******************************************************************************************************************************************************************************/
+    class compiled_network {
+
+    private:
+        typedef void (*native_function)(const double *inputs, double *outputs);
+
+        // Interpreter, source of the phenotype and fallback
+        feed_forward_network network;
+
+        // Loaded shared object, closed with the last copy
+        std::shared_ptr<void> library;
+        native_function native = nullptr;
+
+        std::string cache_directory;
+        std::string compiler;
+
+        /****************************************************
+         * Code generation / loading
+         ****************************************************/
+        std::string emit_source(uint64_t ui_hash) const;
+
+        bool build(const std::string &s_source, const std::string &s_library) const;
+
+        bool load(const std::string &s_library, uint64_t ui_hash);
+
+        void compile();
+
+    public:
+        /****************************************************
+         * Constructor, an empty compiler means $CXX or c++
+         ****************************************************/
+        explicit compiled_network(const std::string &cache_directory, const std::string &compiler = "");
+
+
+        /****************************************************
+         * Create neuralnet from genome, compile or load it from the cache
+         ****************************************************/
+        void from_genome(cneat::genome &g);
+
+        /****************************************************
+         * Same, optimize the phenotype before it is compiled
+         ****************************************************/
+        optimization_report from_genome(cneat::genome &g, double prune_weight);
+
+        /****************************************************
+         * True if activate() runs native code
+         ****************************************************/
+        bool is_native() const;
+
+
+        /****************************************************
+         * Evalutae the genome
+         ****************************************************/
+        void activate(std::vector<double> &inputs, std::vector<double> &outputs);
+
+        void activate(const double *inputs, double *outputs);
+
+    };
+
+} // End of namesace cann
+
+#endif //CNEAT_TRADER_CANN_COMPILED_H
@@ -0,0 +1,308 @@
+//
+//  cann_recurrent.cpp
+//  CNT
+//
+
+// C / C++
+#include <algorithm>
+#include <unordered_set>
+
+// External
+
+// Project
+#include "cann_recurrent.h"
+
+
+/****************************************************
+ *
+ * Every node which reaches an output over expressed
+ * connections is evaluated, cycles included, in the
+ * order of g.node_genes. Inputs occupy the first
+ * slots, followed by the outputs. A node without
+ * expressed inputs is the constant act(bias).
+ *
+ * @brief recurrent_network::from_genome
+ * @param g
+ *
+ ****************************************************/
+template<typename T>
+void cann::basic_recurrent_network<T>::from_genome(cneat::genome &g)
+{
+    this->input_keys.clear();
+    this->output_keys.clear();
+    this->output_slots.clear();
+    this->neurons.clear();
+    this->links.clear();
+    this->values.clear();
+    this->next_values.clear();
+
+    if (g.input_pins.empty())
+    {
+        ErrorLog::LogError("INPUT PINS OF GENOME EMPTY", "/home/AnnErrorLog.dat");
+    }
+
+    this->input_keys = g.input_pins;
+    this->output_keys = g.output_pins;
+
+    // Gather expressed connections, grouped by their target node
+    std::unordered_map<int, std::vector<std::pair<int, double>>> node_inputs;
+    for (auto &it_connection : g.connection_genes)
+    {
+        if (it_connection.enabled)
+        {
+            node_inputs[static_cast<int>(it_connection.to_node)].push_back(
+                    std::make_pair(it_connection.from_node, it_connection.weight));
+        }
+    }
+
+    // Walk back from the outputs, stop at the inputs
+    std::unordered_set<int> inputs(input_keys.begin(), input_keys.end());
+    std::unordered_set<int> required;
+    std::vector<int> frontier;
+    for (auto output : output_keys)
+    {
+        if (required.insert(output).second)
+        {
+            frontier.push_back(output);
+        }
+    }
+    while (!frontier.empty())
+    {
+        int node = frontier.back();
+        frontier.pop_back();
+
+        auto it_inputs = node_inputs.find(node);
+        if (it_inputs == node_inputs.end())
+        {
+            continue;
+        }
+        for (auto &it_input : it_inputs->second)
+        {
+            if (inputs.count(it_input.first) == 0 && required.insert(it_input.first).second)
+            {
+                frontier.push_back(it_input.first);
+            }
+        }
+    }
+
+    std::unordered_map<int, unsigned int> slots;
+    auto get_slot = [&slots](int key) -> unsigned int {
+        auto it_slot = slots.find(key);
+        if (it_slot != slots.end())
+        {
+            return it_slot->second;
+        }
+
+        unsigned int slot = static_cast<unsigned int>(slots.size());
+        slots.emplace(key, slot);
+        return slot;
+    };
+
+    for (auto input : input_keys)
+    {
+        get_slot(input);
+    }
+
+    for (auto output : output_keys)
+    {
+        output_slots.push_back(get_slot(output));
+    }
+
+    // The first gene with a key wins, like in feed_forward_network
+    std::unordered_set<int> seen;
+    for (auto &node_gene : g.node_genes)
+    {
+        int node = static_cast<int>(node_gene.key);
+        if (required.count(node) == 0 || inputs.count(node) != 0 || !seen.insert(node).second)
+        {
+            continue;
+        }
+
+        compiled_neuron new_neuron;
+        new_neuron.slot = get_slot(node);
+        new_neuron.aggregation_function = node_gene.aggregation_function;
+        new_neuron.activation_function = node_gene.activation_function;
+        new_neuron.response = static_cast<T>(node_gene.response);
+        new_neuron.bias = static_cast<T>(node_gene.bias);
+        new_neuron.first_link = static_cast<unsigned int>(links.size());
+
+        // Sources without a node gene get their own slot and stay 0.0
+        auto it_inputs = node_inputs.find(node);
+        if (it_inputs != node_inputs.end())
+        {
+            for (auto &it_input : it_inputs->second)
+            {
+                link new_link;
+                new_link.slot = get_slot(it_input.first);
+                new_link.weight = static_cast<T>(it_input.second);
+                this->links.push_back(new_link);
+            }
+        }
+
+        new_neuron.last_link = static_cast<unsigned int>(links.size());
+        this->neurons.push_back(new_neuron);
+    }
+
+    this->values.assign(slots.size(), 0.0);
+    this->next_values.assign(slots.size(), 0.0);
+}
+
+/****************************************************
+ *
+ * Set the state of every node back to 0.0, e.g.
+ * before the network sees another series
+ *
+ * @brief recurrent_network::reset
+ *
+ ****************************************************/
+template<typename T>
+void cann::basic_recurrent_network<T>::reset()
+{
+    std::fill(this->values.begin(), this->values.end(), static_cast<T>(0.0));
+    std::fill(this->next_values.begin(), this->next_values.end(), static_cast<T>(0.0));
+}
+
+template<typename T>
+void cann::basic_recurrent_network<T>::activate(std::vector<T> &inputs, std::vector<T> &outputs)
+{
+    // Check if inputs.size == input_keys.size
+    if (inputs.size() != this->input_keys.size())
+    {
+        ErrorLog::LogError("Inputs.size() != input_keys.size()", "/home/AnnErrorLog.dat");
+        throw std::runtime_error("Inputs.size() != input_keys.size()");
+    }
+
+    if (outputs.size() >= this->output_slots.size())
+    {
+        this->activate(inputs.data(), outputs.data());
+    } else {
+
+        std::vector<T> vec_out(this->output_slots.size());
+        this->activate(inputs.data(), vec_out.data());
+        std::copy(vec_out.begin(), vec_out.begin() + outputs.size(), outputs.begin());
+    }
+}
+
+/****************************************************
+ *
+ * One time step: every neuron reads the values of the
+ * previous step and the inputs of this one, writes
+ * output_keys.size() values to outputs.
+ *
+ * @brief recurrent_network::activate
+ * @param inputs
+ * @param outputs
+ *
+ ****************************************************/
+template<typename T>
+void cann::basic_recurrent_network<T>::activate(const T *inputs, T *outputs)
+{
+    //Define
+    T s;
+    T *p_next = this->next_values.data();
+    const link *p_links = this->links.data();
+
+    // Set input values, the inputs occupy the first slots
+    std::copy(inputs, inputs + this->input_keys.size(), this->values.begin());
+    std::copy(inputs, inputs + this->input_keys.size(), p_next);
+
+    // Computation loop
+    for (const compiled_neuron &it_neuron : this->neurons)
+    {
+        const link *p_first = p_links + it_neuron.first_link;
+        const link *p_last = p_links + it_neuron.last_link;
+
+        // Aggregation function
+        switch (it_neuron.aggregation_function)
+        {
+            case 1:
+                s = agg_prod(p_first, p_last);
+                break;
+
+            case 2:
+                s = agg_mean(p_first, p_last);
+                break;
+
+            default:
+                s = agg_sum(p_first, p_last);
+                break;
+        }
+
+        // Activation function
+        s = s * it_neuron.response + it_neuron.bias;
+        switch (it_neuron.activation_function)
+        {
+            case 1:
+                p_next[it_neuron.slot] = std::tanh(s);
+                break;
+
+            case 2:
+                p_next[it_neuron.slot] = std::sin(s);
+                break;
+
+            default:
+                p_next[it_neuron.slot] = 1 / (1 + std::exp(-1 * s));
+                break;
+        }
+    }
+
+    this->values.swap(this->next_values);
+
+    // Push output values to output vector
+    size_t us_outputSize = this->output_slots.size();
+    for (size_t us_it = 0; us_it < us_outputSize; us_it++)
+    {
+        outputs[us_it] = this->values[this->output_slots[us_it]];
+    }
+}
+
+
+/********************************************************************************************************
+ * Aggregationfunctions, over the values of the previous step
+ ********************************************************************************************************/
+
+template<typename T>
+T cann::basic_recurrent_network<T>::agg_sum(const link *first, const link *last) const
+{
+    T ret = 0.0;
+    for (; first != last; ++first)
+    {
+        ret += values[first->slot] * first->weight;
+    }
+
+    return ret;
+}
+
+/****************************************************
+ * Starts at 0.0 like feed_forward_network::agg_prod
+ ****************************************************/
+template<typename T>
+T cann::basic_recurrent_network<T>::agg_prod(const link *first, const link *last) const
+{
+    T ret = 0.0;
+    for (; first != last; ++first)
+    {
+        ret *= values[first->slot] * first->weight;
+    }
+
+    return ret;
+}
+
+template<typename T>
+T cann::basic_recurrent_network<T>::agg_mean(const link *first, const link *last) const
+{
+    T ret = 0.0;
+    size_t us_count = static_cast<size_t>(last - first);
+    for (; first != last; ++first)
+    {
+        ret += values[first->slot] * first->weight;
+    }
+    ret = ret / us_count;
+
+    return ret;
+}
+
+
+// Scalar types of the network
+template class cann::basic_recurrent_network<double>;
+template class cann::basic_recurrent_network<float>;
@@ -0,0 +1,106 @@
+//
+//  cann_recurrent.h
+//  CNT
+//
+
+#ifndef CNEAT_TRADER_CANN_RECURRENT_H
+#define CNEAT_TRADER_CANN_RECURRENT_H
+
+
+// C / C++
+#include <vector>
+
+// External
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+
+// Project
+#include <cann.h>
+
+
+namespace cann {
+
+    /******************************************************************************************************************************************************************************
+     *
+     * Neural network class for recurrent networks.
+     * Every activate() is one time step: each node reads the values of the previous step, so
+     * the node state is kept between calls and a signal needs one step per connection.
+     * Fed one candle per step instead of a window of candles.
+     * Same aggregation and activation functions as basic_feed_forward_network.
+     *
+     * @brief The basic_recurrent_network class
+     *
+     ******************************************************************************************************************************************************************************/
+    template<typename T>
+    class basic_recurrent_network {
+
+    public:
+        typedef T value_type;
+        typedef basic_link<T> link;
+        typedef basic_compiled_neuron<T> compiled_neuron;
+
+    private:
+        // Perma stuff
+        std::vector<int> input_keys;
+        std::vector<int> output_keys;
+
+        // Compiled phenotype: node keys remapped to dense slots, inputs first, then outputs
+        std::vector<unsigned int> output_slots;
+        std::vector<compiled_neuron> neurons;
+        std::vector<link> links;
+
+        // Values of the previous and of the current step, swapped every activation
+        std::vector<T> values;
+        std::vector<T> next_values;
+
+        /****************************************************
+         * Aggregation functions over the previous step
+         ****************************************************/
+        inline T agg_sum(const link *first, const link *last) const;
+
+        inline T agg_mean(const link *first, const link *last) const;
+
+        inline T agg_prod(const link *first, const link *last) const;
+
+    public:
+        /****************************************************
+         * Create neuralnet from genome, the state starts at 0.0
+         ****************************************************/
+        void from_genome(cneat::genome &g);
+
+        /****************************************************
+         * Set the state of every node back to 0.0
+         ****************************************************/
+        void reset();
+
+
+        /****************************************************
+         * Advance one step
+         ****************************************************/
+        void activate(std::vector<T> &inputs, std::vector<T> &outputs);
+
+        void activate(const T *inputs, T *outputs);
+
+
+        template<class Archive>
+        void serialization(Archive &archive) {
+
+            archive(input_keys,
+                    output_keys,
+                    output_slots,
+                    neurons,
+                    links,
+                    values,
+                    next_values);
+        }
+
+    };
+
+    typedef basic_recurrent_network<double> recurrent_network;
+
+    extern template class basic_recurrent_network<double>;
+    extern template class basic_recurrent_network<float>;
+
+} // End of namesace cann
+
+#endif //CNEAT_TRADER_CANN_RECURRENT_H
@@ -0,0 +1,63 @@
+//
+//  cann_simd.cpp
+//  CNT
+//
+
+// C / C++
+
+// External
+
+// Project
+#include "cann_simd.h"
+
+
+namespace {
+
+    /****************************************************
+     * Pick the widest instruction set the CPU supports
+     ****************************************************/
+    const cann::simd::kernel_table &select_kernels()
+    {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            return cann::simd::avx512_kernels;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            return cann::simd::avx2_kernels;
+        }
+#endif
+        return cann::simd::sse2_kernels;
+    }
+
+    const cann::simd::kernel_table &kernels()
+    {
+        static const cann::simd::kernel_table &s_Kernels = select_kernels();
+        return s_Kernels;
+    }
+
+} // End of anonymous namespace
+
+
+void cann::simd::act_sig(const double *in, double *out, size_t n)
+{
+    kernels().sig(in, out, n);
+}
+
+void cann::simd::act_tanh(const double *in, double *out, size_t n)
+{
+    kernels().tanh(in, out, n);
+}
+
+void cann::simd::act_sin(const double *in, double *out, size_t n)
+{
+    kernels().sin(in, out, n);
+}
+
+const char *cann::simd::instruction_set()
+{
+    return kernels().name;
+}
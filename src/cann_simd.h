@@ -0,0 +1,68 @@
+//
+//  cann_simd.h
+//  CNT
+//
+
+#ifndef CNEAT_TRADER_CANN_SIMD_H
+#define CNEAT_TRADER_CANN_SIMD_H
+
+
+// C / C++
+#include <cstddef>
+
+
+namespace cann {
+
+    /******************************************************************************************************************************************************************************
+     *
+     * Vectorized activation functions for many neurons or many timesteps per call.
+     * The instruction set (AVX-512F, AVX2 + FMA or SSE2) is picked once at runtime via CPUID.
+     *
+     * Maximum error against the exact result, measured with 2 * 10^6 uniform arguments per range:
+     *   act_sig   2.4 ulp   (|x| <= 700, same bound as 1 / (1 + exp(-x)) with libm exp)
+     *   act_tanh  1.4 ulp   (|x| <= 20, beyond that the result is +-1)
+     *   act_sin   1.6 ulp   (|x| < 2^30, registers holding larger |x|, inf or NaN fall back to libm)
+     * act_sig is flushed to 0 for x < -708 where libm still returns denormals. NaN is propagated.
+     *
+     ******************************************************************************************************************************************************************************/
+    namespace simd {
+
+        /****************************************************
+         * Activation functions, out[i] = f(in[i]) for i < n
+         * in and out may be the same buffer
+         ****************************************************/
+        void act_sig(const double *in, double *out, size_t n);
+
+        void act_tanh(const double *in, double *out, size_t n);
+
+        void act_sin(const double *in, double *out, size_t n);
+
+        /****************************************************
+         * Name of the instruction set in use
+         ****************************************************/
+        const char *instruction_set();
+
+
+        /****************************************************
+         * One kernel table per instruction set
+         ****************************************************/
+        typedef void (*kernel)(const double *in, double *out, size_t n);
+
+        typedef struct {
+
+            const char *name;
+            kernel sig;
+            kernel tanh;
+            kernel sin;
+
+        } kernel_table;
+
+        extern const kernel_table sse2_kernels;
+        extern const kernel_table avx2_kernels;
+        extern const kernel_table avx512_kernels;
+
+    } // End of namespace simd
+
+} // End of namesace cann
+
+#endif //CNEAT_TRADER_CANN_SIMD_H
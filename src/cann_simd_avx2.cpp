@@ -0,0 +1,67 @@
+//
+//  cann_simd_avx2.cpp
+//  CNT
+//
+//  Compiled with -mavx2 -mfma, only reached if the CPU reports both.
+//
+
+// C / C++
+#include <immintrin.h>
+
+// External
+
+// Project
+#include "cann_simd.h"
+
+
+namespace {
+
+    /****************************************************
+     * AVX2 + FMA wrapper, 4 doubles per register
+     ****************************************************/
+    struct avx2 {
+
+        typedef __m256d reg;
+        typedef __m256d mask;
+        static const size_t width = 4;
+
+        static inline reg load(const double *p) { return _mm256_loadu_pd(p); }
+        static inline void store(double *p, reg x) { _mm256_storeu_pd(p, x); }
+        static inline reg set1(double f64_X) { return _mm256_set1_pd(f64_X); }
+
+        static inline reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+        static inline reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+        static inline reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+        static inline reg div(reg a, reg b) { return _mm256_div_pd(a, b); }
+        static inline reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+        static inline reg fnmadd(reg a, reg b, reg c) { return _mm256_fnmadd_pd(a, b, c); }
+        static inline reg min(reg a, reg b) { return _mm256_min_pd(a, b); }
+        static inline reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+        static inline reg abs(reg a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+        static inline reg round(reg a) { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+        // 2^n for integral n in [-1022, 1023]
+        static inline reg pow2n(reg n)
+        {
+            __m256i bits = _mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(6755399441055744.0 + 1023.0)));
+            return _mm256_castsi256_pd(_mm256_slli_epi64(bits, 52));
+        }
+
+        static inline mask cmp_lt(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+        static inline mask cmp_gt(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+        static inline mask cmp_eq(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+        static inline reg select(mask m, reg a, reg b) { return _mm256_blendv_pd(b, a, m); }
+        static inline bool all(mask m) { return _mm256_movemask_pd(m) == 0xF; }
+    };
+
+} // End of anonymous namespace
+
+#include "cann_simd_impl.hpp"
+
+
+const cann::simd::kernel_table cann::simd::avx2_kernels = {
+        "AVX2",
+        apply_sig<avx2>,
+        apply_tanh<avx2>,
+        apply_sin<avx2>
+};
@@ -0,0 +1,67 @@
+//
+//  cann_simd_avx512.cpp
+//  CNT
+//
+//  Compiled with -mavx512f, only reached if the CPU reports it.
+//
+
+// C / C++
+#include <immintrin.h>
+
+// External
+
+// Project
+#include "cann_simd.h"
+
+
+namespace {
+
+    /****************************************************
+     * AVX-512F wrapper, 8 doubles per register
+     ****************************************************/
+    struct avx512 {
+
+        typedef __m512d reg;
+        typedef __mmask8 mask;
+        static const size_t width = 8;
+
+        static inline reg load(const double *p) { return _mm512_loadu_pd(p); }
+        static inline void store(double *p, reg x) { _mm512_storeu_pd(p, x); }
+        static inline reg set1(double f64_X) { return _mm512_set1_pd(f64_X); }
+
+        static inline reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+        static inline reg sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+        static inline reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+        static inline reg div(reg a, reg b) { return _mm512_div_pd(a, b); }
+        static inline reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+        static inline reg fnmadd(reg a, reg b, reg c) { return _mm512_fnmadd_pd(a, b, c); }
+        static inline reg min(reg a, reg b) { return _mm512_min_pd(a, b); }
+        static inline reg max(reg a, reg b) { return _mm512_max_pd(a, b); }
+        static inline reg abs(reg a) { return _mm512_abs_pd(a); }
+        static inline reg round(reg a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+        // 2^n for integral n in [-1022, 1023]
+        static inline reg pow2n(reg n)
+        {
+            __m512i bits = _mm512_castpd_si512(_mm512_add_pd(n, _mm512_set1_pd(6755399441055744.0 + 1023.0)));
+            return _mm512_castsi512_pd(_mm512_slli_epi64(bits, 52));
+        }
+
+        static inline mask cmp_lt(reg a, reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+        static inline mask cmp_gt(reg a, reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+        static inline mask cmp_eq(reg a, reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+        static inline reg select(mask m, reg a, reg b) { return _mm512_mask_blend_pd(m, b, a); }
+        static inline bool all(mask m) { return m == 0xFF; }
+    };
+
+} // End of anonymous namespace
+
+#include "cann_simd_impl.hpp"
+
+
+const cann::simd::kernel_table cann::simd::avx512_kernels = {
+        "AVX-512F",
+        apply_sig<avx512>,
+        apply_tanh<avx512>,
+        apply_sin<avx512>
+};
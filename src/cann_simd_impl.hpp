@@ -0,0 +1,268 @@
+//
+//  cann_simd_impl.hpp
+//  CNT
+//
+//  Generic kernels of cann_simd.h, written against an instruction set wrapper V.
+//  Only included by the cann_simd_<isa>.cpp files, which are compiled with the flags of their
+//  instruction set. Everything in here must keep internal linkage, so no code built for a
+//  wider instruction set can leak into the rest of the program.
+//
+
+#ifndef CNEAT_TRADER_CANN_SIMD_IMPL_HPP
+#define CNEAT_TRADER_CANN_SIMD_IMPL_HPP
+
+
+// C / C++
+#include <cstddef>
+#include <cmath>
+
+
+namespace {
+
+    /****************************************************
+     * Constants (Cephes Math Library, S. L. Moshier)
+     ****************************************************/
+
+    // exp
+    const double f64_ExpMax = 708.0;
+    const double f64_Log2e = 1.4426950408889634073599;
+    const double f64_Ln2Hi = 6.93145751953125E-1;
+    const double f64_Ln2Lo = 1.42860682030941723212E-6;
+    const double f64_ExpP0 = 1.26177193074810590878E-4;
+    const double f64_ExpP1 = 3.02994407707441961300E-2;
+    const double f64_ExpP2 = 9.99999999999999999910E-1;
+    const double f64_ExpQ0 = 3.00198505138664455042E-6;
+    const double f64_ExpQ1 = 2.52448340349684104192E-3;
+    const double f64_ExpQ2 = 2.27265548208155028766E-1;
+    const double f64_ExpQ3 = 2.00000000000000000009E0;
+
+    // tanh, rational approximation for |x| < 0.625
+    const double f64_TanhSmall = 0.625;
+    const double f64_TanhP0 = -9.64399179425052238628E-1;
+    const double f64_TanhP1 = -9.92877231001918586564E1;
+    const double f64_TanhP2 = -1.61468768441708447952E3;
+    const double f64_TanhQ0 = 1.12811678491632931402E2;
+    const double f64_TanhQ1 = 2.23548839060100448583E3;
+    const double f64_TanhQ2 = 4.84406305325125486048E3;
+
+    // sin, reduction to octants of pi / 4
+    const double f64_SinMax = 1.073741824e9;
+    const double f64_FourOverPi = 1.27323954473516268615;
+    const double f64_PiO4A = 7.85398125648498535156E-1;
+    const double f64_PiO4B = 3.77489470793079817668E-8;
+    const double f64_PiO4C = 2.69515142907905952645E-15;
+    const double f64_SinC0 = 1.58962301576546568060E-10;
+    const double f64_SinC1 = -2.50507477628578072866E-8;
+    const double f64_SinC2 = 2.75573136213857245213E-6;
+    const double f64_SinC3 = -1.98412698295895385996E-4;
+    const double f64_SinC4 = 8.33333333332211858878E-3;
+    const double f64_SinC5 = -1.66666666666666307295E-1;
+    const double f64_CosC0 = -1.13585365213876817300E-11;
+    const double f64_CosC1 = 2.08757008419747316778E-9;
+    const double f64_CosC2 = -2.75573141792967388112E-7;
+    const double f64_CosC3 = 2.48015872888517045348E-5;
+    const double f64_CosC4 = -1.38888888888730564116E-3;
+    const double f64_CosC5 = 4.16666666666665929218E-2;
+
+
+    /****************************************************
+     *
+     * floor() for arguments >= 0
+     *
+     ****************************************************/
+    template<class V>
+    inline typename V::reg floor_positive(typename V::reg x)
+    {
+        typename V::reg r = V::round(x);
+        return V::sub(r, V::select(V::cmp_gt(r, x), V::set1(1.0), V::set1(0.0)));
+    }
+
+    /****************************************************
+     *
+     * exp(x), inf above 708 and 0 below -708
+     *
+     ****************************************************/
+    template<class V>
+    inline typename V::reg exp(typename V::reg x)
+    {
+        // min / max return their second operand for NaN, which keeps NaN
+        typename V::reg c = V::min(V::set1(f64_ExpMax), V::max(V::set1(-f64_ExpMax), x));
+
+        // exp(x) = 2^n * exp(r), |r| <= ln(2) / 2
+        typename V::reg n = V::round(V::mul(c, V::set1(f64_Log2e)));
+        typename V::reg r = V::fnmadd(n, V::set1(f64_Ln2Hi), c);
+        r = V::fnmadd(n, V::set1(f64_Ln2Lo), r);
+
+        // exp(r) = 1 + 2 * P(r^2) * r / (Q(r^2) - P(r^2) * r)
+        typename V::reg rr = V::mul(r, r);
+        typename V::reg px = V::fmadd(V::fmadd(V::set1(f64_ExpP0), rr, V::set1(f64_ExpP1)), rr, V::set1(f64_ExpP2));
+        px = V::mul(px, r);
+        typename V::reg qx = V::fmadd(V::fmadd(V::fmadd(V::set1(f64_ExpQ0), rr, V::set1(f64_ExpQ1)), rr,
+                                               V::set1(f64_ExpQ2)), rr, V::set1(f64_ExpQ3));
+        r = V::div(px, V::sub(qx, px));
+        r = V::mul(V::fmadd(V::set1(2.0), r, V::set1(1.0)), V::pow2n(n));
+
+        // Saturate like libm, tiny results would only leave denormals in the network
+        r = V::select(V::cmp_gt(x, V::set1(f64_ExpMax)), V::set1(HUGE_VAL), r);
+        return V::select(V::cmp_lt(x, V::set1(-f64_ExpMax)), V::set1(0.0), r);
+    }
+
+    /****************************************************
+     *
+     * Sigmoid function
+     *
+     ****************************************************/
+    template<class V>
+    inline typename V::reg sig(typename V::reg x)
+    {
+        typename V::reg one = V::set1(1.0);
+        return V::div(one, V::add(one, exp<V>(V::sub(V::set1(0.0), x))));
+    }
+
+    /****************************************************
+     *
+     * Tangens hyperbolicus function
+     *
+     ****************************************************/
+    template<class V>
+    inline typename V::reg tanh(typename V::reg x)
+    {
+        typename V::reg one = V::set1(1.0);
+        typename V::reg ax = V::abs(x);
+
+        // |x| >= 0.625: 1 - 2 / (exp(2|x|) + 1), with the sign of x
+        typename V::reg large = V::sub(one, V::div(V::set1(2.0), V::add(exp<V>(V::add(ax, ax)), one)));
+        large = V::select(V::cmp_lt(x, V::set1(0.0)), V::sub(V::set1(0.0), large), large);
+
+        // |x| < 0.625: x + x * z * P(z) / Q(z), z = x^2
+        typename V::reg z = V::mul(x, x);
+        typename V::reg p = V::fmadd(V::fmadd(V::set1(f64_TanhP0), z, V::set1(f64_TanhP1)), z, V::set1(f64_TanhP2));
+        typename V::reg q = V::fmadd(V::fmadd(V::add(z, V::set1(f64_TanhQ0)), z, V::set1(f64_TanhQ1)), z,
+                                     V::set1(f64_TanhQ2));
+        typename V::reg small = V::fmadd(V::mul(x, z), V::div(p, q), x);
+
+        return V::select(V::cmp_lt(ax, V::set1(f64_TanhSmall)), small, large);
+    }
+
+    /****************************************************
+     *
+     * Sinus function, |x| < f64_SinMax
+     *
+     ****************************************************/
+    template<class V>
+    inline typename V::reg sin(typename V::reg x)
+    {
+        typename V::reg zero = V::set1(0.0);
+        typename V::reg one = V::set1(1.0);
+        typename V::reg sign = V::select(V::cmp_lt(x, zero), V::set1(-1.0), one);
+        x = V::abs(x);
+
+        // Octant j of x, mapped to an even octant
+        typename V::reg y = floor_positive<V>(V::mul(x, V::set1(f64_FourOverPi)));
+        typename V::reg j = V::sub(y, V::mul(V::set1(8.0), floor_positive<V>(V::mul(y, V::set1(0.125)))));
+        typename V::reg odd = V::select(
+                V::cmp_gt(V::sub(j, V::mul(V::set1(2.0), floor_positive<V>(V::mul(j, V::set1(0.5))))), zero), one, zero);
+        y = V::add(y, odd);
+        j = V::add(j, odd);
+        j = V::select(V::cmp_gt(j, V::set1(7.0)), zero, j);
+
+        typename V::mask upper = V::cmp_gt(j, V::set1(3.0));
+        sign = V::select(upper, V::sub(zero, sign), sign);
+        j = V::select(upper, V::sub(j, V::set1(4.0)), j);
+
+        // Extended precision modular arithmetic
+        typename V::reg z = V::fnmadd(y, V::set1(f64_PiO4A), x);
+        z = V::fnmadd(y, V::set1(f64_PiO4B), z);
+        z = V::fnmadd(y, V::set1(f64_PiO4C), z);
+        typename V::reg zz = V::mul(z, z);
+
+        // sin(z) = z + z^3 * S(z^2)
+        typename V::reg s = V::fmadd(V::fmadd(V::fmadd(V::fmadd(V::fmadd(V::set1(f64_SinC0), zz, V::set1(f64_SinC1)), zz,
+                                     V::set1(f64_SinC2)), zz, V::set1(f64_SinC3)), zz, V::set1(f64_SinC4)), zz,
+                                     V::set1(f64_SinC5));
+        s = V::fmadd(V::mul(z, zz), s, z);
+
+        // cos(z) = 1 - z^2 / 2 + z^4 * C(z^2)
+        typename V::reg c = V::fmadd(V::fmadd(V::fmadd(V::fmadd(V::fmadd(V::set1(f64_CosC0), zz, V::set1(f64_CosC1)), zz,
+                                     V::set1(f64_CosC2)), zz, V::set1(f64_CosC3)), zz, V::set1(f64_CosC4)), zz,
+                                     V::set1(f64_CosC5));
+        c = V::fmadd(V::mul(zz, zz), c, V::fnmadd(V::set1(0.5), zz, one));
+
+        return V::mul(sign, V::select(V::cmp_eq(j, V::set1(2.0)), c, s));
+    }
+
+
+    /****************************************************
+     *
+     * Apply F to in[0, n), the tail is computed in a padded register
+     *
+     ****************************************************/
+    template<class V, typename V::reg (*F)(typename V::reg)>
+    void apply(const double *in, double *out, size_t n)
+    {
+        size_t i = 0;
+        for (; i + V::width <= n; i += V::width)
+        {
+            V::store(out + i, F(V::load(in + i)));
+        }
+
+        if (i < n)
+        {
+            double tail[V::width] = {0.0};
+            for (size_t k = 0; i + k < n; k++)
+            {
+                tail[k] = in[i + k];
+            }
+
+            V::store(tail, F(V::load(tail)));
+            for (size_t k = 0; i + k < n; k++)
+            {
+                out[i + k] = tail[k];
+            }
+        }
+    }
+
+    template<class V>
+    void apply_sig(const double *in, double *out, size_t n)
+    {
+        apply<V, sig<V>>(in, out, n);
+    }
+
+    template<class V>
+    void apply_tanh(const double *in, double *out, size_t n)
+    {
+        apply<V, tanh<V>>(in, out, n);
+    }
+
+    /****************************************************
+     *
+     * Arguments beyond f64_SinMax (and NaN / inf) lose the
+     * reduction precision, those registers are left to libm
+     *
+     ****************************************************/
+    template<class V>
+    inline typename V::reg sin_checked(typename V::reg x)
+    {
+        if (V::all(V::cmp_lt(V::abs(x), V::set1(f64_SinMax))))
+        {
+            return sin<V>(x);
+        }
+
+        double lanes[V::width];
+        V::store(lanes, x);
+        for (size_t k = 0; k < V::width; k++)
+        {
+            lanes[k] = std::sin(lanes[k]);
+        }
+        return V::load(lanes);
+    }
+
+    template<class V>
+    void apply_sin(const double *in, double *out, size_t n)
+    {
+        apply<V, sin_checked<V>>(in, out, n);
+    }
+
+} // End of anonymous namespace
+
+#endif //CNEAT_TRADER_CANN_SIMD_IMPL_HPP
@@ -0,0 +1,71 @@
+//
+//  cann_simd_sse2.cpp
+//  CNT
+//
+
+// C / C++
+#include <emmintrin.h>
+
+// External
+
+// Project
+#include "cann_simd.h"
+
+
+namespace {
+
+    /****************************************************
+     * SSE2 wrapper, 2 doubles per register
+     ****************************************************/
+    struct sse2 {
+
+        typedef __m128d reg;
+        typedef __m128d mask;
+        static const size_t width = 2;
+
+        static inline reg load(const double *p) { return _mm_loadu_pd(p); }
+        static inline void store(double *p, reg x) { _mm_storeu_pd(p, x); }
+        static inline reg set1(double f64_X) { return _mm_set1_pd(f64_X); }
+
+        static inline reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+        static inline reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+        static inline reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+        static inline reg div(reg a, reg b) { return _mm_div_pd(a, b); }
+        static inline reg fmadd(reg a, reg b, reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+        static inline reg fnmadd(reg a, reg b, reg c) { return _mm_sub_pd(c, _mm_mul_pd(a, b)); }
+        static inline reg min(reg a, reg b) { return _mm_min_pd(a, b); }
+        static inline reg max(reg a, reg b) { return _mm_max_pd(a, b); }
+        static inline reg abs(reg a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+
+        // Round to nearest, valid for |x| < 2^51
+        static inline reg round(reg a)
+        {
+            reg magic = _mm_set1_pd(6755399441055744.0);
+            return _mm_sub_pd(_mm_add_pd(a, magic), magic);
+        }
+
+        // 2^n for integral n in [-1022, 1023]
+        static inline reg pow2n(reg n)
+        {
+            __m128i bits = _mm_castpd_si128(_mm_add_pd(n, _mm_set1_pd(6755399441055744.0 + 1023.0)));
+            return _mm_castsi128_pd(_mm_slli_epi64(bits, 52));
+        }
+
+        static inline mask cmp_lt(reg a, reg b) { return _mm_cmplt_pd(a, b); }
+        static inline mask cmp_gt(reg a, reg b) { return _mm_cmpgt_pd(a, b); }
+        static inline mask cmp_eq(reg a, reg b) { return _mm_cmpeq_pd(a, b); }
+        static inline reg select(mask m, reg a, reg b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+        static inline bool all(mask m) { return _mm_movemask_pd(m) == 0x3; }
+    };
+
+} // End of anonymous namespace
+
+#include "cann_simd_impl.hpp"
+
+
+const cann::simd::kernel_table cann::simd::sse2_kernels = {
+        "SSE2",
+        apply_sig<sse2>,
+        apply_tanh<sse2>,
+        apply_sin<sse2>
+};
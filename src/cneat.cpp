@@ -1065,17 +1065,46 @@ double cneat::pool::distance(genome &g1, genome &g2)
 
 /************************************************************************
  * Rank all genomes and report current Max Fitness;
+ * champion_score replaces the fitness of every species champion,
+ * on_new_best gets every genome that raises it
  *
  * @brief pool::rank_globally
  *
  ************************************************************************/
 void cneat::pool::rank_globally()
 {
-    for (auto s = this->species.begin(); s != this->species.end(); s++)
-    {
+    // Every species on its own, the champions are re-scored in parallel
+    auto rank_specie = [this](size_t us_specie) {
+        specie *s = &this->species[us_specie];
+
         std::sort(s->genomes.begin(), s->genomes.end(), [](genome &a, genome &b) -> bool {
             return a.fitness > b.fitness; // was a->fitness < b->fitness
         });
+
+        // Re-score the champion before it is compared and saved, then move it down to its rank,
+        // the rest stays sorted
+        if (this->champion_score && !s->genomes.empty())
+        {
+            s->genomes[0].fitness = this->champion_score(s->genomes[0]);
+
+            auto it_rank = std::upper_bound(s->genomes.begin() + 1, s->genomes.end(), s->genomes[0],
+                                            [](const genome &a, const genome &b) -> bool {
+                                                return a.fitness > b.fitness;
+                                            });
+            std::rotate(s->genomes.begin(), s->genomes.begin() + 1, it_rank);
+        }
+    };
+
+    if (this->parallel_for)
+    {
+        this->parallel_for(this->species.size(), rank_specie);
+    }
+    else
+    {
+        for (size_t us_specie = 0; us_specie < this->species.size(); us_specie++)
+        {
+            rank_specie(us_specie);
+        }
     }
 
     for (auto s : this->species)
@@ -1101,6 +1130,11 @@ void cneat::pool::rank_globally()
             this->best_fitness = s.genomes[0].fitness;
             this->best_connCnt = s.genomes[0].connection_genes.size();
             this->best_nodeCnt = s.genomes[0].node_genes.size();
+
+            if (this->on_new_best)
+            {
+                this->on_new_best(s.genomes[0], this->generation_number);
+            }
         }
     }
 }
@@ -1281,17 +1315,53 @@ void cneat::pool::add_to_species(genome &child)
     auto s = this->species.begin();
     std::uniform_int_distribution<unsigned int> choice;
 
-    // Check if child-genome by genetic distance belongs to a species
-    while (s != this->species.end())
+    if (this->parallel_for && this->species.size() > 1)
     {
-        choice = std::uniform_int_distribution<unsigned int>(0, s->genomes.size() - 1);
+        /*
+         * Check every species at once. The representatives are drawn from a copy of the
+         * generator, which is advanced afterwards by the draws the loop below would have
+         * made up to the first match, so the result does not depend on the threads
+         */
+        std::mt19937 draw_generator = this->generator;
+        std::vector<unsigned int> representatives(this->species.size());
+        for (size_t us_specie = 0; us_specie < this->species.size(); us_specie++)
+        {
+            choice = std::uniform_int_distribution<unsigned int>(0, this->species[us_specie].genomes.size() - 1);
+            representatives[us_specie] = choice(draw_generator);
+        }
+
+        std::vector<char> belongs(this->species.size(), 0);
+        this->parallel_for(this->species.size(), [this, &child, &representatives, &belongs](size_t us_specie) {
+            belongs[us_specie] = this->distance(this->species[us_specie].genomes[representatives[us_specie]], child);
+        });
 
-        if (this->distance((*s).genomes[choice(this->generator)], child))
+        size_t us_match = std::find(belongs.begin(), belongs.end(), 1) - belongs.begin();
+        for (size_t us_specie = 0; us_specie < this->species.size() && us_specie <= us_match; us_specie++)
+        {
+            choice = std::uniform_int_distribution<unsigned int>(0, this->species[us_specie].genomes.size() - 1);
+            choice(this->generator);
+        }
+
+        s += us_match;
+        if (s != this->species.end())
         {
             (*s).genomes.push_back(child);
-            break;
         }
-        ++s;
+    }
+    else
+    {
+        // Check if child-genome by genetic distance belongs to a species
+        while (s != this->species.end())
+        {
+            choice = std::uniform_int_distribution<unsigned int>(0, s->genomes.size() - 1);
+
+            if (this->distance((*s).genomes[choice(this->generator)], child))
+            {
+                (*s).genomes.push_back(child);
+                break;
+            }
+            ++s;
+        }
     }
 
     /*********************************************************
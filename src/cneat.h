@@ -19,6 +19,7 @@
 #include <string>
 #include <climits>
 #include <chrono>
+#include <functional>
 #include <sys/stat.h>
 
 // External
@@ -493,6 +494,19 @@ namespace cneat {
         /* default Genome info */
         defaultGenome default_Genome;
 
+        /* Fitness of a species champion for ranking and saving, e.g. on more data than
+         * the evaluation used. Empty == the evaluated fitness is used */
+        std::function<double(genome &)> champion_score;
+
+        /* Called with every genome that raises max_fitness and the generation, e.g. to
+         * validate it on other data. Empty == nothing is called */
+        std::function<void(const genome &, unsigned int)> on_new_best;
+
+        /* Runs task(i) for every i < count, possibly on several threads at once. Used
+         * for the work of independent species and the distances of a child to the
+         * species. Empty == one after the other */
+        std::function<void(size_t, const std::function<void(size_t)> &)> parallel_for;
+
         /* Pointer to best genome */
 
         std::string session_path;
@@ -0,0 +1,253 @@
+//
+//  cann_layers_test.cpp
+//  CNT
+//
+//  Checks feed_forward_network::required_for_output() and feed_forward_layers() against
+//  the quadratic scans they replaced, on the stored genomes and on random ones.
+//  Usage: cann_layers_test <res directory>
+//
+
+// C / C++
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <glob.h>
+
+// External
+
+// Project
+#include "../src/cneat.h"
+#include "../src/cann.h"
+
+
+/**************************************************************************************
+ * Reference
+ * ---------
+ * The scans over all connections per step, as before the adjacency index.
+ **************************************************************************************/
+
+static std::vector<int> reference_required_for_output(const std::vector<int> &input, const std::vector<int> &output,
+                                                      const std::vector<cneat::connection_gene> &connections) {
+    std::vector<int> required;
+    std::vector<int> s;
+
+    for (int it_output : output) {
+        if (std::find(s.begin(), s.end(), it_output) == s.end()) {
+            s.push_back(it_output);
+        }
+        if (std::find(required.begin(), required.end(), it_output) == required.end()) {
+            required.push_back(it_output);
+        }
+    }
+
+    while (true) {
+        // Nodes not in s whose output is consumed by a node in s
+        std::vector<int> t;
+        for (auto &it_conn : connections) {
+            if (std::find(s.begin(), s.end(), it_conn.from_node) == s.end() &&
+                std::find(s.begin(), s.end(), it_conn.to_node) != s.end() &&
+                std::find(t.begin(), t.end(), it_conn.from_node) == t.end()) {
+                t.push_back(it_conn.from_node);
+            }
+        }
+
+        if (t.empty()) {
+            break;
+        }
+
+        std::vector<int> layer_nodes;
+        for (int it_t : t) {
+            if (std::find(input.begin(), input.end(), it_t) == input.end() &&
+                std::find(layer_nodes.begin(), layer_nodes.end(), it_t) == layer_nodes.end()) {
+                layer_nodes.push_back(it_t);
+            }
+        }
+
+        if (layer_nodes.empty()) {
+            break;
+        }
+
+        for (int it_node : layer_nodes) {
+            if (std::find(required.begin(), required.end(), it_node) == required.end()) {
+                required.push_back(it_node);
+            }
+        }
+        for (int it_t : t) {
+            if (std::find(s.begin(), s.end(), it_t) == s.end()) {
+                s.push_back(it_t);
+            }
+        }
+    }
+
+    return required;
+}
+
+static std::vector<std::vector<int>> reference_feed_forward_layers(const std::vector<int> &input,
+                                                                   const std::vector<int> &output,
+                                                                   const std::vector<cneat::connection_gene> &connections) {
+    std::vector<int> required = reference_required_for_output(input, output, connections);
+    std::vector<std::vector<int>> layers;
+    std::vector<int> s(input.begin(), input.end());
+
+    while (true) {
+        // Nodes fed by s which are not in s yet
+        std::vector<int> c;
+        for (auto &it_conn : connections) {
+            if (std::find(s.begin(), s.end(), it_conn.from_node) != s.end() &&
+                std::find(s.begin(), s.end(), it_conn.to_node) == s.end() &&
+                std::find(c.begin(), c.end(), it_conn.to_node) == c.end()) {
+                c.push_back(it_conn.to_node);
+            }
+        }
+
+        // The required ones with every input in s
+        std::vector<int> t;
+        for (int it_c : c) {
+            bool b_ready = true;
+            for (auto &it_conn : connections) {
+                if (it_conn.to_node == it_c && std::find(s.begin(), s.end(), it_conn.from_node) == s.end()) {
+                    b_ready = false;
+                }
+            }
+
+            if (b_ready && std::find(required.begin(), required.end(), it_c) != required.end() &&
+                std::find(t.begin(), t.end(), it_c) == t.end()) {
+                t.push_back(it_c);
+            }
+        }
+
+        if (t.empty()) {
+            break;
+        }
+
+        layers.push_back(t);
+        for (int it_t : t) {
+            if (std::find(s.begin(), s.end(), it_t) == s.end()) {
+                s.push_back(it_t);
+            }
+        }
+    }
+
+    return layers;
+}
+
+/**************************************************************************************
+ * Genomes
+ * -------
+ * Stored ones and random ones with disabled and duplicate links, self loops and cycles.
+ **************************************************************************************/
+
+static void load_genomes(const std::string &s_Pattern, std::vector<cneat::genome> &v_Genomes) {
+    cneat::network_info_container s_Info{1, 2, false, "/tmp"};
+    cneat::mutation_rate_container s_Rates;
+    glob_t s_Glob;
+
+    if (glob(s_Pattern.c_str(), 0, NULL, &s_Glob) != 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < s_Glob.gl_pathc; i++) {
+        cneat::genome s_Genome(s_Info, s_Rates, 0);
+        std::ifstream fs_Genome(s_Glob.gl_pathv[i], std::ios::binary);
+        cereal::BinaryInputArchive c_Archive(fs_Genome);
+        s_Genome.serialize(c_Archive);
+        v_Genomes.push_back(s_Genome);
+    }
+
+    globfree(&s_Glob);
+}
+
+static void random_genomes(size_t us_Count, std::vector<cneat::genome> &v_Genomes) {
+    cneat::mutation_rate_container s_Rates;
+    std::mt19937 s_Random(42);
+
+    for (size_t i = 0; i < us_Count; i++) {
+        cneat::network_info_container s_Info{static_cast<unsigned int>(1 + s_Random() % 8),
+                                             static_cast<unsigned int>(1 + s_Random() % 3), false, "/tmp"};
+        cneat::genome s_Genome(s_Info, s_Rates, 0);
+
+        unsigned int ui_Hidden = s_Random() % 30;
+        for (unsigned int h = 0; h < ui_Hidden; h++) {
+            s_Genome.node_genes.push_back(cneat::node_gene{10 + h, 0, 0, 0, 0});
+        }
+
+        unsigned int ui_Links = s_Random() % 120;
+        for (unsigned int l = 0; l < ui_Links; l++) {
+            cneat::connection_gene s_Link;
+            s_Link.key = l;
+            s_Link.weight = 1.0;
+            s_Link.enabled = s_Random() % 4 != 0;
+            s_Link.from_node = s_Random() % 3 == 0
+                               ? s_Genome.input_pins[s_Random() % s_Genome.input_pins.size()]
+                               : static_cast<int>(s_Genome.node_genes[s_Random() % s_Genome.node_genes.size()].key);
+            s_Link.to_node = s_Genome.node_genes[s_Random() % s_Genome.node_genes.size()].key;
+
+            // Mostly acyclic
+            if (s_Random() % 3 != 0 && s_Link.from_node >= 0 && s_Link.from_node >= static_cast<int>(s_Link.to_node)) {
+                continue;
+            }
+            s_Genome.connection_genes.push_back(s_Link);
+        }
+
+        v_Genomes.push_back(s_Genome);
+    }
+}
+
+/**************************************************************************************
+ * Test
+ **************************************************************************************/
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <res directory>" << std::endl;
+        return 2;
+    }
+
+    std::string s_Res(argv[1]);
+    std::vector<cneat::genome> v_Genomes;
+
+    load_genomes(s_Res + "/Best Genomes server1/*.genome", v_Genomes);
+    load_genomes(s_Res + "/template/*.genome", v_Genomes);
+    size_t us_Stored = v_Genomes.size();
+    random_genomes(300, v_Genomes);
+
+    if (us_Stored == 0) {
+        std::cerr << "No stored genomes in " << s_Res << std::endl;
+        return 1;
+    }
+
+    size_t us_Failed = 0;
+    for (size_t i = 0; i < v_Genomes.size(); i++) {
+        cneat::genome &s_Genome = v_Genomes[i];
+        cann::feed_forward_network s_Network;
+
+        // All links and only the expressed ones, as from_genome() passes them
+        std::vector<cneat::connection_gene> v_Enabled;
+        for (auto &it_Link : s_Genome.connection_genes) {
+            if (it_Link.enabled) {
+                v_Enabled.push_back(it_Link);
+            }
+        }
+
+        for (std::vector<cneat::connection_gene> *p_Links : {&s_Genome.connection_genes, &v_Enabled}) {
+            bool b_Required = s_Network.required_for_output(s_Genome.input_pins, s_Genome.output_pins, *p_Links) ==
+                              reference_required_for_output(s_Genome.input_pins, s_Genome.output_pins, *p_Links);
+            bool b_Layers = s_Network.feed_forward_layers(s_Genome.input_pins, s_Genome.output_pins, *p_Links) ==
+                            reference_feed_forward_layers(s_Genome.input_pins, s_Genome.output_pins, *p_Links);
+
+            if (!b_Required || !b_Layers) {
+                std::cerr << "Genome " << i << (i < us_Stored ? " (stored)" : " (random)") << ": "
+                          << (b_Required ? "" : "required_for_output ") << (b_Layers ? "" : "feed_forward_layers ")
+                          << "differ" << std::endl;
+                ++us_Failed;
+            }
+        }
+    }
+
+    std::cout << v_Genomes.size() << " genomes, " << us_Stored << " stored, " << us_Failed << " mismatches" << std::endl;
+
+    return us_Failed == 0 ? 0 : 1;
+}
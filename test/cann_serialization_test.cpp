@@ -0,0 +1,209 @@
+//
+//  cann_serialization_test.cpp
+//  CNT
+//
+//  Saves the networks of the stored genomes the way Main writes Winner.cann and
+//  Winner_cann.json, loads them into fresh networks and checks that every engine of the
+//  loaded network returns the same outputs as the original one. Recurrent networks are
+//  saved in the middle of a run and have to continue from the same state.
+//  Usage: cann_serialization_test <res directory>
+//
+
+// C / C++
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <glob.h>
+
+// External
+#include <../include/cereal/archives/binary.hpp>
+#include <../include/cereal/archives/json.hpp>
+
+// Project
+#include "../src/cneat.h"
+#include "../src/cann.h"
+#include "../src/cann_recurrent.h"
+
+
+/**************************************************************************************
+ * Genomes
+ **************************************************************************************/
+
+static void load_genomes(const std::string &s_Pattern, std::vector<cneat::genome> &v_Genomes) {
+    cneat::network_info_container s_Info{1, 2, false, "/tmp"};
+    cneat::mutation_rate_container s_Rates;
+    glob_t s_Glob;
+
+    if (glob(s_Pattern.c_str(), 0, NULL, &s_Glob) != 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < s_Glob.gl_pathc; i++) {
+        cneat::genome s_Genome(s_Info, s_Rates, 0);
+        std::ifstream fs_Genome(s_Glob.gl_pathv[i], std::ios::binary);
+        cereal::BinaryInputArchive c_Archive(fs_Genome);
+        s_Genome.serialize(c_Archive);
+        v_Genomes.push_back(s_Genome);
+    }
+
+    globfree(&s_Glob);
+}
+
+/**************************************************************************************
+ * Round trip
+ **************************************************************************************/
+
+template<class OutputArchive, class InputArchive, class Network>
+static void round_trip(Network &s_Network, Network &s_Loaded) {
+    std::stringstream ss_Archive;
+    {
+        OutputArchive c_Out(ss_Archive);
+        s_Network.serialization(c_Out);
+    }
+    {
+        InputArchive c_In(ss_Archive);
+        s_Loaded.serialization(c_In);
+    }
+}
+
+// Rows of random inputs, row t starts at t * us_Inputs
+static std::vector<double> random_rows(size_t us_Rows, size_t us_Inputs) {
+    std::mt19937 s_Random(7);
+    std::uniform_real_distribution<double> s_Uniform(-2.0, 2.0);
+    std::vector<double> v_Rows(us_Rows * us_Inputs);
+
+    for (auto &it_Value : v_Rows) {
+        it_Value = s_Uniform(s_Random);
+    }
+    return v_Rows;
+}
+
+/**************************************************************************************
+ * Feed forward
+ **************************************************************************************/
+
+static size_t check_feed_forward(cneat::genome &s_Genome, int i_Engine, const std::vector<double> &v_Rows,
+                                 size_t us_Rows) {
+    size_t us_Inputs = s_Genome.input_pins.size();
+    size_t us_Outputs = s_Genome.output_pins.size();
+    size_t us_Failed = 0;
+
+    cann::feed_forward_network s_Network;
+    s_Network.from_genome(s_Genome);
+    s_Network.set_engine(i_Engine);
+
+    std::vector<double> v_Expected(us_Rows * us_Outputs), v_ExpectedBatch(us_Rows * us_Outputs);
+    for (size_t t = 0; t < us_Rows; t++) {
+        s_Network.activate(v_Rows.data() + t * us_Inputs, v_Expected.data() + t * us_Outputs);
+    }
+    s_Network.activate_batch(v_Rows.data(), us_Rows, static_cast<ptrdiff_t>(us_Inputs), v_ExpectedBatch.data());
+
+    for (int i_Format = 0; i_Format < 2; i_Format++) {
+        cann::feed_forward_network s_Loaded;
+        if (i_Format == 0) {
+            round_trip<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>(s_Network, s_Loaded);
+        } else {
+            round_trip<cereal::JSONOutputArchive, cereal::JSONInputArchive>(s_Network, s_Loaded);
+        }
+
+        std::vector<double> v_Out(us_Rows * us_Outputs), v_Batch(us_Rows * us_Outputs);
+        for (size_t t = 0; t < us_Rows; t++) {
+            s_Loaded.activate(v_Rows.data() + t * us_Inputs, v_Out.data() + t * us_Outputs);
+        }
+        s_Loaded.activate_batch(v_Rows.data(), us_Rows, static_cast<ptrdiff_t>(us_Inputs), v_Batch.data());
+
+        // JSON keeps 17 digits, the values are the same
+        if (v_Out != v_Expected || v_Batch != v_ExpectedBatch) {
+            std::cerr << "feed_forward_network engine " << i_Engine << (i_Format == 0 ? " binary" : " json") << ": "
+                      << (v_Out != v_Expected ? "activate " : "") << (v_Batch != v_ExpectedBatch ? "activate_batch " : "")
+                      << "differ after loading" << std::endl;
+            ++us_Failed;
+        }
+    }
+
+    return us_Failed;
+}
+
+/**************************************************************************************
+ * Recurrent
+ **************************************************************************************/
+
+static size_t check_recurrent(cneat::genome &s_Genome, const std::vector<double> &v_Rows, size_t us_Rows) {
+    size_t us_Inputs = s_Genome.input_pins.size();
+    size_t us_Outputs = s_Genome.output_pins.size();
+    size_t us_Saved = us_Rows / 2;
+    size_t us_Failed = 0;
+
+    cann::recurrent_network s_Network;
+    s_Network.from_genome(s_Genome);
+
+    std::vector<double> v_Out(us_Outputs);
+    for (size_t t = 0; t < us_Saved; t++) {
+        s_Network.activate(v_Rows.data() + t * us_Inputs, v_Out.data());
+    }
+
+    for (int i_Format = 0; i_Format < 2; i_Format++) {
+        cann::recurrent_network s_Original = s_Network, s_Loaded;
+        if (i_Format == 0) {
+            round_trip<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>(s_Original, s_Loaded);
+        } else {
+            round_trip<cereal::JSONOutputArchive, cereal::JSONInputArchive>(s_Original, s_Loaded);
+        }
+
+        std::vector<double> v_Expected(us_Outputs);
+        bool b_Same = true;
+        for (size_t t = us_Saved; t < us_Rows; t++) {
+            s_Original.activate(v_Rows.data() + t * us_Inputs, v_Expected.data());
+            s_Loaded.activate(v_Rows.data() + t * us_Inputs, v_Out.data());
+            b_Same = b_Same && v_Out == v_Expected;
+        }
+
+        if (!b_Same) {
+            std::cerr << "recurrent_network" << (i_Format == 0 ? " binary" : " json")
+                      << ": activate differs after loading" << std::endl;
+            ++us_Failed;
+        }
+    }
+
+    return us_Failed;
+}
+
+/**************************************************************************************
+ * Test
+ **************************************************************************************/
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <res directory>" << std::endl;
+        return 2;
+    }
+
+    std::string s_Res(argv[1]);
+    std::vector<cneat::genome> v_Genomes;
+
+    load_genomes(s_Res + "/Best Genomes server1/*.genome", v_Genomes);
+
+    if (v_Genomes.empty()) {
+        std::cerr << "No stored genomes in " << s_Res << std::endl;
+        return 1;
+    }
+
+    const size_t us_Rows = 64;
+    size_t us_Failed = 0;
+
+    for (auto &it_Genome : v_Genomes) {
+        std::vector<double> v_Rows = random_rows(us_Rows, it_Genome.input_pins.size());
+
+        for (int i_Engine : {0, 1}) {
+            us_Failed += check_feed_forward(it_Genome, i_Engine, v_Rows, us_Rows);
+        }
+        us_Failed += check_recurrent(it_Genome, v_Rows, us_Rows);
+    }
+
+    std::cout << v_Genomes.size() << " genomes, " << us_Failed << " mismatches" << std::endl;
+
+    return us_Failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+//
+//  cann_simd_test.cpp
+//  CNT
+//
+//  Checks the act_sig, act_tanh and act_sin kernels of every instruction set the CPU
+//  supports against the error bounds of cann_simd.h. The exact result is taken in long
+//  double, libm is measured next to the kernels.
+//
+
+// C / C++
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+// External
+
+// Project
+#include "../src/cann_simd.h"
+
+
+namespace {
+
+    enum function { SIG, TANH, SIN };
+
+    /**
+     *  A range of uniform arguments and the documented bound of the kernels on it.
+     */
+
+    struct test_range {
+        function e_Function;
+        const char *p_Name;
+        double f64_Low;
+        double f64_High;
+        double f64_MaxUlp;
+    };
+
+    /**************************************************************************************
+     * Reference
+     **************************************************************************************/
+
+    long double exact(function e_Function, double f64_X) {
+        long double x = f64_X;
+
+        switch (e_Function) {
+            case SIG:
+                return 1.0L / (1.0L + std::exp(-x));
+            case TANH:
+                return std::tanh(x);
+            default:
+                return std::sin(x);
+        }
+    }
+
+    double libm(function e_Function, double f64_X) {
+        switch (e_Function) {
+            case SIG:
+                return 1.0 / (1.0 + std::exp(-f64_X));
+            case TANH:
+                return std::tanh(f64_X);
+            default:
+                return std::sin(f64_X);
+        }
+    }
+
+    // Error in units of the last place of the exact result
+    double ulp_error(long double f80_Exact, double f64_Result) {
+        double f64_Exact = static_cast<double>(f80_Exact);
+
+        if (f64_Exact == 0.0) {
+            return f64_Result == 0.0 ? 0.0 : std::numeric_limits<double>::infinity();
+        }
+
+        double f64_Ulp = std::nextafter(std::fabs(f64_Exact), std::numeric_limits<double>::infinity()) -
+                         std::fabs(f64_Exact);
+        return static_cast<double>(std::fabs(static_cast<long double>(f64_Result) - f80_Exact) / f64_Ulp);
+    }
+
+    cann::simd::kernel get_kernel(const cann::simd::kernel_table &s_Table, function e_Function) {
+        return e_Function == SIG ? s_Table.sig : e_Function == TANH ? s_Table.tanh : s_Table.sin;
+    }
+
+    /**************************************************************************************
+     * Instruction sets
+     **************************************************************************************/
+
+    std::vector<const cann::simd::kernel_table *> supported_kernels() {
+        std::vector<const cann::simd::kernel_table *> v_Tables = {&cann::simd::sse2_kernels};
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            v_Tables.push_back(&cann::simd::avx2_kernels);
+        }
+        if (__builtin_cpu_supports("avx512f")) {
+            v_Tables.push_back(&cann::simd::avx512_kernels);
+        }
+#endif
+        return v_Tables;
+    }
+
+    /**************************************************************************************
+     * Special arguments
+     **************************************************************************************/
+
+    bool same(double f64_A, double f64_B) {
+        return (std::isnan(f64_A) && std::isnan(f64_B)) || f64_A == f64_B;
+    }
+
+    size_t check_special(const cann::simd::kernel_table &s_Table) {
+        const double f64_Inf = std::numeric_limits<double>::infinity();
+        const double f64_NaN = std::numeric_limits<double>::quiet_NaN();
+        size_t us_Failed = 0;
+
+        struct special {
+            function e_Function;
+            double f64_X;
+            double f64_Expected;
+        } v_Special[] = {
+                {SIG, f64_NaN, f64_NaN},
+                {SIG, -709.0, 0.0}, // Flushed below -708
+                {SIG, -f64_Inf, 0.0},
+                {SIG, f64_Inf, 1.0},
+                {SIG, 0.0, 0.5},
+                {TANH, f64_NaN, f64_NaN},
+                {TANH, 21.0, 1.0},
+                {TANH, -21.0, -1.0},
+                {TANH, f64_Inf, 1.0},
+                {TANH, 0.0, 0.0},
+                {SIN, f64_NaN, f64_NaN},
+                {SIN, f64_Inf, f64_NaN},
+                {SIN, 2e9, std::sin(2e9)}, // Falls back to libm
+                {SIN, 1e300, std::sin(1e300)},
+                {SIN, 0.0, 0.0}
+        };
+
+        for (auto &it_Special : v_Special) {
+            // Once alone and once in a full register
+            double p_In[8], p_Out[8];
+            for (size_t i = 0; i < 8; i++) {
+                p_In[i] = i == 0 ? it_Special.f64_X : 0.5;
+            }
+
+            for (size_t us_Count : {static_cast<size_t>(1), static_cast<size_t>(8)}) {
+                get_kernel(s_Table, it_Special.e_Function)(p_In, p_Out, us_Count);
+
+                if (!same(p_Out[0], it_Special.f64_Expected)) {
+                    std::printf("%s: f(%g) == %g, expected %g\n", s_Table.name, it_Special.f64_X, p_Out[0],
+                                it_Special.f64_Expected);
+                    ++us_Failed;
+                }
+            }
+        }
+
+        return us_Failed;
+    }
+
+} // End of anonymous namespace
+
+
+/**************************************************************************************
+ * Test
+ **************************************************************************************/
+
+int main() {
+    // Odd, the tail after the last full register is checked as well
+    const size_t us_Samples = 500001;
+
+    const test_range v_Ranges[] = {
+            {SIG, "act_sig", -40.0, 40.0, 2.4},
+            {SIG, "act_sig", -700.0, 700.0, 2.4},
+            {TANH, "act_tanh", -1.0, 1.0, 1.4},
+            {TANH, "act_tanh", -20.0, 20.0, 1.4},
+            {SIN, "act_sin", -10.0, 10.0, 1.6},
+            {SIN, "act_sin", -1e6, 1e6, 1.6},
+            {SIN, "act_sin", -1e9, 1e9, 1.6}
+    };
+
+    std::vector<const cann::simd::kernel_table *> v_Tables = supported_kernels();
+    std::vector<double> v_In(us_Samples), v_Out(us_Samples);
+    std::vector<long double> v_Exact(us_Samples);
+    std::mt19937_64 s_Random(1);
+    size_t us_Failed = 0;
+
+    std::printf("Selected: %s\n", cann::simd::instruction_set());
+
+    for (auto &it_Range : v_Ranges) {
+        std::uniform_real_distribution<double> s_Uniform(it_Range.f64_Low, it_Range.f64_High);
+        double f64_Libm = 0.0;
+
+        for (size_t i = 0; i < us_Samples; i++) {
+            v_In[i] = s_Uniform(s_Random);
+            v_Exact[i] = exact(it_Range.e_Function, v_In[i]);
+            f64_Libm = std::max(f64_Libm, ulp_error(v_Exact[i], libm(it_Range.e_Function, v_In[i])));
+        }
+
+        for (auto p_Table : v_Tables) {
+            double f64_Max = 0.0;
+
+            get_kernel(*p_Table, it_Range.e_Function)(v_In.data(), v_Out.data(), us_Samples);
+            for (size_t i = 0; i < us_Samples; i++) {
+                double f64_Error = ulp_error(v_Exact[i], v_Out[i]);
+
+                // NaN stays, it fails the bound
+                if (std::isnan(f64_Error) || f64_Error > f64_Max) {
+                    f64_Max = f64_Error;
+                }
+            }
+
+            bool b_Passed = f64_Max <= it_Range.f64_MaxUlp;
+            us_Failed += b_Passed ? 0 : 1;
+
+            std::printf("%-8s %-8s [%g, %g]: %.3f ulp, bound %.1f, libm %.3f ulp %s\n", it_Range.p_Name,
+                        p_Table->name, it_Range.f64_Low, it_Range.f64_High, f64_Max, it_Range.f64_MaxUlp, f64_Libm,
+                        b_Passed ? "" : "FAILED");
+        }
+    }
+
+    for (auto p_Table : v_Tables) {
+        us_Failed += check_special(*p_Table);
+    }
+
+    return us_Failed == 0 ? 0 : 1;
+}